@@ -4,6 +4,14 @@
 #include "classes/Checkers.h"
 #include "classes/Othello.h"
 #include "classes/Connect4.h"
+#include "classes/Chess.h"
+#include "classes/TextureAtlas.h"
+#include "classes/Animation.h"
+#include "classes/Profiler.h"
+#include "core/GameRecord.h"
+#include "core/Scheduler.h"
+#include "core/Trace.h"
+#include <atomic>
 
 namespace ClassGame {
         //
@@ -13,6 +21,22 @@ namespace ClassGame {
         bool gameOver = false;
         int gameWinner = -1;
 
+        //
+        // idle throttling, the main loop sleeps on input when nothing needs drawing
+        // ImGui needs a couple of frames after a change before its layout settles
+        //
+        const int kRedrawFrames = 3;
+        std::atomic<int> redrawFrames = kRedrawFrames;
+        bool eventDriven = true;
+        // set by main before anything can ask for a redraw, so it needs no lock
+        void (*wakeUpMainLoop)() = nullptr;
+
+        //
+        // every finished game is appended here, read them back with the records tool
+        //
+        const char *kGameRecordPath = "games.mc4r";
+        GameRecordWriter gameRecords;
+
         //
         // game starting point
         // this is called by the main render loop in main.cpp
@@ -20,6 +44,86 @@ namespace ClassGame {
         void GameStartUp() 
         {
             game = nullptr;
+            Tracer::shared().setThreadName("main");
+            // pack all the piece and board images into one texture so boards batch into a single draw call
+            TextureAtlas::shared().build("resources");
+            gameRecords.open(kGameRecordPath);
+        }
+
+        //
+        // record a timeline and save it as chrome trace json, open it at ui.perfetto.dev
+        //
+        static void RenderTraceControls()
+        {
+            static const char *kTracePath = "trace.json";
+            static std::string lastSaved;
+            Tracer &tracer = Tracer::shared();
+            if (!tracer.isEnabled()) {
+                if (ImGui::Button("Start trace")) {
+                    tracer.setEnabled(true);
+                    lastSaved.clear();
+                }
+                if (!lastSaved.empty()) {
+                    ImGui::SameLine();
+                    ImGui::Text("%s", lastSaved.c_str());
+                }
+                return;
+            }
+            if (ImGui::Button("Save trace")) {
+                tracer.setEnabled(false);
+                uint64_t events = tracer.eventCount();
+                lastSaved = tracer.writeJson(kTracePath) ? std::to_string(events) + " events saved to " + kTracePath : "couldn't write " + std::string(kTracePath);
+                return;
+            }
+            ImGui::SameLine();
+            ImGui::Text("recording, %llu events", (unsigned long long)tracer.eventCount());
+        }
+
+        //
+        // what the AI's last search cost, updated after every AI move
+        //
+        static void RenderSearchStats(const SearchStats &stats)
+        {
+            if (!ImGui::CollapsingHeader("Search", ImGuiTreeNodeFlags_DefaultOpen)) {
+                return;
+            }
+            if (stats.playouts > 0) {
+                ImGui::Text("Win rate %d%%  tree depth %d", stats.score, stats.depth);
+                ImGui::Text("Playouts %llu  %.0f playouts/s  %.1f ms", (unsigned long long)stats.playouts, stats.playoutsPerSecond(), stats.microseconds / 1000.0);
+                ImGui::Text("Tree %llu nodes, %llu playouts kept from the last move", (unsigned long long)stats.treeNodes, (unsigned long long)stats.reusedPlayouts);
+                ImGui::TextWrapped("PV %s", stats.pv.c_str());
+                return;
+            }
+            if (stats.iterations.empty()) {
+                ImGui::Text("No search yet");
+                return;
+            }
+            ImGui::Text("Depth %d  Score %d", stats.depth, stats.score);
+            ImGui::Text("Nodes %llu  %.0f nodes/s  %.1f ms", (unsigned long long)stats.nodes, stats.nodesPerSecond(), stats.microseconds / 1000.0);
+            ImGui::Text("Cutoffs %llu, %.0f%% on the first move", (unsigned long long)stats.cutoffs, stats.firstMoveCutoffRate() * 100.0);
+            ImGui::Text("Branching %.2f average, %.2f effective", stats.averageBranching(), stats.effectiveBranching());
+            ImGui::Text("TT probes %llu  hits %.1f%%  cutoffs %llu", (unsigned long long)stats.ttProbes, stats.ttHitRate() * 100.0, (unsigned long long)stats.ttCutoffs);
+            ImGui::Text("TT %.1f MB, %.1f%% filled by this search", stats.tableBytes / (1024.0 * 1024.0), stats.tableFill / 10.0);
+            ImGui::TextWrapped("PV %s", stats.pv.c_str());
+            if (ImGui::BeginTable("Iterations", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+                ImGui::TableSetupColumn("Depth");
+                ImGui::TableSetupColumn("Score");
+                ImGui::TableSetupColumn("Nodes");
+                ImGui::TableSetupColumn("ms");
+                ImGui::TableHeadersRow();
+                for (const SearchIteration &iteration : stats.iterations) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%d", iteration.depth);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%d", iteration.score);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%llu", (unsigned long long)iteration.nodes);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", iteration.microseconds / 1000.0);
+                }
+                ImGui::EndTable();
+            }
         }
 
         //
@@ -34,10 +138,23 @@ namespace ClassGame {
 
                 ImGui::Begin("Settings");
 
+                ImGui::Checkbox("Render only on change", &eventDriven);
+                bool profiling = FrameProfiler::shared().isEnabled();
+                if (ImGui::Checkbox("Frame profiler", &profiling)) {
+                    FrameProfiler::shared().setEnabled(profiling);
+                }
+                RenderTraceControls();
+                if (gameRecords.failed()) {
+                    ImGui::Text("couldn't write %s", kGameRecordPath);
+                } else if (gameRecords.isOpen()) {
+                    ImGui::Text("%llu games recorded to %s", (unsigned long long)gameRecords.games(), kGameRecordPath);
+                }
+
                 if (gameOver) {
                     ImGui::Text("Game Over!");
                     ImGui::Text("Winner: %d", gameWinner);
                     if (ImGui::Button("Reset Game")) {
+                        RequestRedraw();
                         game->stopGame();
                         game->setUpBoard();
                         gameOver = false;
@@ -61,9 +178,39 @@ namespace ClassGame {
                         game = new Connect4();
                         game->setUpBoard();
                     }
+                    if (ImGui::Button("Start Connect 4 (MCTS)")) {
+                        game = new Connect4(Connect4::MONTE_CARLO);
+                        game->setUpBoard();
+                    }
+                    if (ImGui::Button("Start Chess")) {
+                        game = new Chess();
+                        game->setUpBoard();
+                    }
                 } else {
                     ImGui::Text("Current Player Number: %d", game->getCurrentPlayer()->playerNumber());
-                    ImGui::Text("Current Board State: %s", game->stateString().c_str());
+                    std::string state;
+                    {
+                        ProfileScope scope(ProfilePhase::StateString);
+                        state = game->stateString();
+                    }
+                    ImGui::Text("Current Board State: %s", state.c_str());
+#if !defined(SINGLE_THREADED)
+                    if (game->gameCanTimeSlice()) {
+                        bool sliced = game->_gameOptions.AISliceMicroseconds > 0;
+                        if (ImGui::Checkbox("Time-sliced AI", &sliced)) {
+                            game->_gameOptions.AISliceMicroseconds = sliced ? AI_SLICE_MICROSECONDS : 0;
+                        }
+                    }
+#endif
+                    if (game->gameCanPonder()) {
+                        ImGui::Checkbox("Ponder on your turn", &game->_gameOptions.AIPonder);
+                    }
+                    if (game->gameCanAnalyse()) {
+                        ImGui::Checkbox("Show move scores", &game->_gameOptions.AIAnalysis);
+                    }
+                    if (const SearchStats *stats = game->searchStats()) {
+                        RenderSearchStats(*stats);
+                    }
                 }
                 ImGui::End();
 
@@ -71,11 +218,20 @@ namespace ClassGame {
                 if (game) {
                     if (game->gameHasAI() && (game->getCurrentPlayer()->isAIPlayer() || game->_gameOptions.AIvsAI))
                     {
+                        ProfileScope scope(ProfilePhase::UpdateAI);
+                        // the move being waited on, pondering and analysis give their workers up meanwhile
+                        Scheduler::Urgent urgent;
                         game->updateAI();
                     }
                     game->drawFrame();
                 }
                 ImGui::End();
+
+                FrameProfiler::shared().drawOverlay();
+
+                if (redrawFrames > 0) {
+                    redrawFrames--;
+                }
         }
 
         //
@@ -84,6 +240,7 @@ namespace ClassGame {
         //
         void EndOfTurn() 
         {
+            bool wasOver = gameOver;
             Player *winner = game->checkForWinner();
             if (winner)
             {
@@ -94,5 +251,34 @@ namespace ClassGame {
                 gameOver = true;
                 gameWinner = -1;
             }
+            if (gameOver && !wasOver && game->gameRecordTitle() >= 0) {
+                gameRecords.record(game->gameRecord(gameWinner));
+            }
+        }
+
+        void RequestRedraw()
+        {
+            redrawFrames = kRedrawFrames;
+            // the loop may already be asleep, it wouldn't look at redrawFrames again until the idle timeout
+            if (wakeUpMainLoop) {
+                wakeUpMainLoop();
+            }
+        }
+
+        void SetWakeUp(void (*wakeUp)())
+        {
+            wakeUpMainLoop = wakeUp;
+        }
+
+        bool NeedsRedraw()
+        {
+            if (!eventDriven || redrawFrames > 0 || Animator::shared().isAnimating()) {
+                return true;
+            }
+            // the AI moves from inside RenderGame, so keep frames coming until it has
+            if (game && game->needsFrames()) {
+                return true;
+            }
+            return game && !gameOver && game->gameHasAI() && (game->getCurrentPlayer()->isAIPlayer() || game->_gameOptions.AIvsAI);
         }
 }
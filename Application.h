@@ -4,4 +4,10 @@ namespace ClassGame {
     void GameStartUp();
     void RenderGame();
     void EndOfTurn();
+    // ask for a few more frames, safe to call from any thread, wakes the main loop if it's asleep
+    void RequestRedraw();
+    // how the platform's main loop gets woken from another thread, called once at startup
+    void SetWakeUp(void (*wakeUp)());
+    // true while anything on screen can still change without new input
+    bool NeedsRedraw();
 }
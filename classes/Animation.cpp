@@ -0,0 +1,104 @@
+#include "Animation.h"
+#include "Bit.h"
+#include <algorithm>
+
+float ease(Easing easing, float t)
+{
+    t = std::clamp(t, 0.0f, 1.0f);
+    switch (easing) {
+        case Easing::Linear:
+            return t;
+        case Easing::EaseInQuad:
+            return t * t;
+        case Easing::EaseOutQuad:
+            return t * (2.0f - t);
+        case Easing::EaseInOutCubic:
+            return t < 0.5f ? 4.0f * t * t * t : 1.0f - (-2.0f * t + 2.0f) * (-2.0f * t + 2.0f) * (-2.0f * t + 2.0f) / 2.0f;
+        case Easing::EaseOutBounce:
+        {
+            // standard piecewise bounce, three shrinking hops before settling
+            const float n = 7.5625f;
+            const float d = 2.75f;
+            if (t < 1.0f / d) {
+                return n * t * t;
+            } else if (t < 2.0f / d) {
+                t -= 1.5f / d;
+                return n * t * t + 0.75f;
+            } else if (t < 2.5f / d) {
+                t -= 2.25f / d;
+                return n * t * t + 0.9375f;
+            }
+            t -= 2.625f / d;
+            return n * t * t + 0.984375f;
+        }
+    }
+    return t;
+}
+
+Animator &Animator::shared()
+{
+    static Animator animator;
+    return animator;
+}
+
+void Animator::moveBit(Bit *bit, const ImVec2 &destination, float duration, Easing easing)
+{
+    Animation animation = { bit, bit->getPosition(), destination, 0.0f, duration, easing };
+    bit->_moving = true;
+    // a bit only ever has one animation, a new move replaces the old one from where it is now
+    for (Animation &running : _active) {
+        if (running.bit == bit) {
+            running = animation;
+            return;
+        }
+    }
+    _active.push_back(animation);
+}
+
+void Animator::cancel(Bit *bit)
+{
+    for (size_t i = 0; i < _active.size(); i++) {
+        if (_active[i].bit == bit) {
+            bit->_moving = false;
+            _active[i] = _active.back();
+            _active.pop_back();
+            return;
+        }
+    }
+}
+
+void Animator::finishAll()
+{
+    while (!_active.empty()) {
+        _finish(_active.size() - 1);
+    }
+}
+
+void Animator::update(float deltaTime)
+{
+    size_t i = 0;
+    while (i < _active.size()) {
+        Animation &animation = _active[i];
+        animation.elapsed += deltaTime;
+        if (animation.elapsed >= animation.duration) {
+            _finish(i);
+            continue;
+        }
+        float k = ease(animation.easing, animation.elapsed / animation.duration);
+        animation.bit->setPosition(animation.start.x + (animation.end.x - animation.start.x) * k,
+                                   animation.start.y + (animation.end.y - animation.start.y) * k);
+        i++;
+    }
+}
+
+//
+// land exactly on the destination and drop the animation, order of the rest doesn't matter
+//
+void Animator::_finish(size_t index)
+{
+    Animation &animation = _active[index];
+    animation.bit->setPosition(animation.end);
+    animation.bit->_moving = false;
+    _active[index] = _active.back();
+    _active.pop_back();
+}
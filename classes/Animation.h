@@ -0,0 +1,57 @@
+#pragma once
+#include "../imgui/imgui.h"
+#include <vector>
+
+class Bit;
+
+//
+// easing curves, t runs from 0 to 1 over the length of the animation
+//
+enum class Easing
+{
+    Linear,
+    EaseInQuad,
+    EaseOutQuad,
+    EaseInOutCubic,
+    EaseOutBounce
+};
+
+float ease(Easing easing, float t);
+
+//
+// time based movement for bits, driven by the frame's delta time so speed doesn't depend on frame rate
+// only running animations are kept, so a still board costs nothing per frame
+//
+class Animator
+{
+public:
+    // the animator the game window updates every frame
+    static Animator &shared();
+
+    // move bit from where it is now to destination over duration seconds
+    void    moveBit(Bit *bit, const ImVec2 &destination, float duration, Easing easing);
+    // stop animating bit and leave it where it is
+    void    cancel(Bit *bit);
+    // jump every animation to its end
+    void    finishAll();
+    // advance every running animation by deltaTime seconds
+    void    update(float deltaTime);
+
+    bool    isAnimating() const { return !_active.empty(); }
+    size_t  activeCount() const { return _active.size(); }
+
+private:
+    struct Animation
+    {
+        Bit     *bit;
+        ImVec2  start;
+        ImVec2  end;
+        float   elapsed;
+        float   duration;
+        Easing  easing;
+    };
+
+    void    _finish(size_t index);
+
+    std::vector<Animation> _active;
+};
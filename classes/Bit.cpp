@@ -1,10 +1,29 @@
 
 #include "Bit.h"
 #include "BitHolder.h"
-#include <cmath>
+#include "BitPool.h"
+
+// how long an ordinary slide between squares takes, in seconds
+static const float kMoveDuration = 0.2f;
 
 Bit::~Bit()
 {
+	if (_moving)
+	{
+		Animator::shared().cancel(this);
+	}
+}
+
+void Bit::destroy()
+{
+	if (_pool)
+	{
+		_pool->release(this);
+	}
+	else
+	{
+		delete this;
+	}
 }
 
 BitHolder *Bit::getHolder()
@@ -76,31 +95,18 @@ Player *Bit::getOwner()
 	return _owner;
 }
 
+void Bit::recolor(Player *player, const TextureRegion &region)
+{
+	_owner = player;
+	setTextureRegion(region);
+}
+
 void Bit::moveTo(const ImVec2 &point)
 {
-	_destinationPosition = point;
-	// work out the step so we move same step each update
-	ImVec2 delta = ImVec2(_destinationPosition.x - getPosition().x, _destinationPosition.y - getPosition().y);
-	_destinationStep = ImVec2(delta.x * 0.05f, delta.y * 0.05f);
-	_moving = true;
+	moveTo(point, kMoveDuration, Easing::EaseOutQuad);
 }
 
-void Bit::update()
+void Bit::moveTo(const ImVec2 &point, float duration, Easing easing)
 {
-	if (!_moving)
-	{
-		return;
-	}
-	ImVec2 pos = getPosition();
-	ImVec2 delta = ImVec2(_destinationPosition.x - pos.x, _destinationPosition.y - pos.y);
-	if (std::fabs(delta.x) >= 0.1f || std::fabs(delta.y) > 0.1f)
-	{
-		ImVec2 newPosition = ImVec2(pos.x + _destinationStep.x, pos.y + _destinationStep.y);
-		setPosition(newPosition);
-	}
-	else
-	{
-		setPosition(_destinationPosition);
-		_moving = false;
-	}
-}
\ No newline at end of file
+	Animator::shared().moveBit(this, point, duration, easing);
+}
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "Sprite.h"
+#include "Animation.h"
 
 class Player;
 class BitHolder;
+class BitPool;
 
 //
 // these aren't used yet but will be used for dragging pieces
@@ -29,10 +31,14 @@ public:
 		_gameTag = 0;
 		_entityType = EntityBit;
 		_moving = false;
+		_pool = nullptr;
 	};
 
 	~Bit();
 
+	// give the bit back to the pool it came from, or delete it if it was new'd
+	void destroy() override;
+
 	// helper functions
 	bool getPickedUp();
 	void setPickedUp(bool yes);
@@ -42,15 +48,17 @@ public:
 	// which player owns me
 	Player *getOwner();
 	void setOwner(Player *player) { _owner = player; };
+	// change owner and look in place, the bit keeps its holder, position and any animation
+	void recolor(Player *player, const TextureRegion &region);
 	// helper functions
 	bool friendly();
 	bool unfriendly();
 	// game defined game tags
 	const int gameTag() const { return _gameTag; };
 	void setGameTag(int tag) { _gameTag = tag; };
-	// move to a position
+	// animate to a position, timed by the frame clock
 	void moveTo(const ImVec2 &point);
-	void update();
+	void moveTo(const ImVec2 &point, float duration, Easing easing);
 	void setOpacity(float opacity){};
 	bool getMoving() { return _moving; };
 
@@ -60,7 +68,10 @@ private:
 	bool _pickedUp;
 	Player *_owner;
 	int _gameTag;
-	ImVec2 _destinationPosition;
-	ImVec2 _destinationStep;
+	// set while the Animator is moving us
+	friend class Animator;
 	bool _moving;
+	// pool this bit was allocated from, nullptr for heap bits
+	friend class BitPool;
+	BitPool *_pool;
 };
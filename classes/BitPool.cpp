@@ -0,0 +1,81 @@
+#include "BitPool.h"
+#include <new>
+
+BitPool::BitPool() : _freeList(nullptr), _slab(0), _used(0), _live(0)
+{
+}
+
+BitPool::~BitPool()
+{
+    reset();
+    for (Slot *slab : _slabs) {
+        delete[] slab;
+    }
+    _slabs.clear();
+}
+
+//
+// free list first, then bump the current slab, then move on to (or create) the next slab
+//
+BitPool::Slot *BitPool::_nextSlot()
+{
+    if (_freeList) {
+        Slot *slot = _freeList;
+        _freeList = slot->next;
+        return slot;
+    }
+    if (_slab < _slabs.size() && _used == kBitsPerSlab) {
+        _slab++;
+        _used = 0;
+    }
+    if (_slab == _slabs.size()) {
+        _slabs.push_back(new Slot[kBitsPerSlab]);
+        _used = 0;
+    }
+    return &_slabs[_slab][_used++];
+}
+
+Bit *BitPool::allocate()
+{
+    Slot *slot = _nextSlot();
+    slot->next = nullptr;
+    slot->live = true;
+    _live++;
+    Bit *bit = new (slot->storage) Bit();
+    bit->_pool = this;
+    return bit;
+}
+
+void BitPool::release(Bit *bit)
+{
+    if (!bit) {
+        return;
+    }
+    bit->~Bit();
+    // storage is the first member, so the bit's address is its slot's address
+    Slot *slot = reinterpret_cast<Slot *>(bit);
+    slot->live = false;
+    slot->next = _freeList;
+    _freeList = slot;
+    _live--;
+}
+
+void BitPool::reset()
+{
+    if (_live > 0) {
+        for (size_t s = 0; s < _slabs.size() && s <= _slab; s++) {
+            size_t used = (s == _slab) ? _used : kBitsPerSlab;
+            for (size_t i = 0; i < used; i++) {
+                Slot &slot = _slabs[s][i];
+                if (slot.live) {
+                    reinterpret_cast<Bit *>(slot.storage)->~Bit();
+                    slot.live = false;
+                }
+            }
+        }
+    }
+    _freeList = nullptr;
+    _slab = 0;
+    _used = 0;
+    _live = 0;
+}
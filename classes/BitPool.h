@@ -0,0 +1,44 @@
+#pragma once
+#include "Bit.h"
+#include <cstddef>
+#include <vector>
+
+//
+// fixed size slab allocator for the pieces of a game
+// new bits come off a free list or are bumped out of the current slab, so placing,
+// capturing and flipping pieces never goes to the heap once the first slab exists
+//
+class BitPool
+{
+public:
+    BitPool();
+    ~BitPool();
+
+    // construct a fresh Bit in the pool
+    Bit     *allocate();
+    // destroy a Bit and put its slot back on the free list
+    void    release(Bit *bit);
+    // destroy anything still alive and rewind every slab, called when a game stops
+    void    reset();
+
+    size_t  liveCount() const { return _live; }
+    size_t  capacity() const { return _slabs.size() * kBitsPerSlab; }
+
+private:
+    static const size_t kBitsPerSlab = 64;
+
+    struct Slot
+    {
+        alignas(Bit) unsigned char storage[sizeof(Bit)];
+        Slot    *next;
+        bool    live;
+    };
+
+    Slot    *_nextSlot();
+
+    std::vector<Slot *> _slabs;
+    Slot    *_freeList;
+    size_t  _slab;  // slab we are bumping out of
+    size_t  _used;  // slots handed out of that slab so far
+    size_t  _live;
+};
@@ -1,9 +1,13 @@
 #pragma once
 #include "Game.h"
+#include "../core/CheckersPosition.h"
 
 // NOTE: If Square class needs modifications to support colored squares for checkerboard pattern,
 // add a method like setColor(ImVec4 color) to Square class
 
+//
+// checkers, the rules live in CheckersPosition, this class lets the player drag pieces one hop at a time
+//
 class Checkers : public Game
 {
 public:
@@ -26,39 +30,26 @@ public:
     // AI methods
     void        updateAI() override;
     bool        gameHasAI() override { return false; } // Set to true when AI is implemented
+    int         gameRecordTitle() override { return RECORD_CHECKERS; }
     Grid* getGrid() override { return _grid; }
 
 private:
-    // Constants for piece types
-    static const int EMPTY = 0;
-    static const int RED_PIECE = 1;
-    static const int RED_KING = 2;
-    static const int YELLOW_PIECE = 3;
-    static const int YELLOW_KING = 4;
-
     // Player constants
     static const int RED_PLAYER = 0;
     static const int YELLOW_PLAYER = 1;
 
     // Helper methods
     Bit*        createPiece(int pieceType);
-    int         getPieceType(const Bit& bit) const;
-    bool        isKing(const Bit& bit) const;
-    bool        isValidMove(int srcX, int srcY, int dstX, int dstY, Player* player) const;
-    bool        isJumpMove(int srcX, int srcY, int dstX, int dstY) const;
-    bool        hasJumpAvailable(Player* player) const;
-    bool        canJumpFrom(ChessSquare& square) const;
-    void        performJump(int srcX, int srcY, int dstX, int dstY);
-    void        promoteToKing(Bit& bit, int y);
-    void        getBoardPosition(BitHolder &holder, int &x, int &y) const;
-    bool        isValidSquare(int x, int y) const;
+    int         squareFor(BitHolder &holder) const;
+    // true if a legal move starts with the hops made so far followed by square
+    bool        continuesMove(int square) const;
+    // add, remove and crown pieces until the board matches the position
+    void        syncPieces();
 
     // Board representation
-    Grid*        _grid;
+    Grid*       _grid;
+    CheckersPosition _position;
 
-    // Game state
-    bool        _mustContinueJumping;
-    BitHolder*  _jumpingPiece;
-    int         _redPieces;
-    int         _yellowPieces;
-};
\ No newline at end of file
+    // hops made so far this turn, a multi jump is dragged one hop at a time
+    CheckersMove _partial;
+};
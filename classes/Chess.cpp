@@ -0,0 +1,206 @@
+#include "Chess.h"
+
+Chess::Chess() : Game() {
+    _grid = new Grid(8, 8);
+}
+
+Chess::~Chess() {
+    delete _grid;
+}
+
+void Chess::setUpBoard() {
+    setNumberOfPlayers(2);
+    _gameOptions.rowX = 8;
+    _gameOptions.rowY = 8;
+    // as deep as a second allows
+    _gameOptions.AIMAXDepth = 32;
+    _gameOptions.AIMoveTime = 1000;
+
+    _grid->initializeSquares(80, "boardsquare.png");
+    _grid->forEachSquare([](ChessSquare* square, int x, int y) {
+        std::string notation;
+        notation += (char)('a' + x);
+        notation += (char)('8' - y);
+        square->setNotation(notation);
+    });
+
+    _position.reset();
+    syncPieces();
+
+    if (gameHasAI()) {
+        setAIPlayer(AI_PLAYER);
+    }
+
+    startGame();
+}
+
+Bit* Chess::createPiece(int piece) {
+    // the white knight's image really is spelled kinight
+    static const char* whiteSprites[] = { "", "w_pawn.png", "w_kinight.png", "w_bishop.png", "w_rook.png", "w_queen.png", "w_king.png" };
+    static const char* blackSprites[] = { "", "b_pawn.png", "b_knight.png", "b_bishop.png", "b_rook.png", "b_queen.png", "b_king.png" };
+    int type = ChessPosition::pieceType(piece);
+    int color = ChessPosition::pieceColor(piece);
+
+    Bit* bit = _bitPool.allocate();
+    bit->LoadTextureFromFile(color == WHITE_PLAYER ? whiteSprites[type] : blackSprites[type]);
+    bit->setOwner(getPlayerAt(color));
+    // ChessSquare tells friend from foe by the 128 bit
+    bit->setGameTag(type + (color == BLACK_PLAYER ? 128 : 0));
+    return bit;
+}
+
+int Chess::squareFor(BitHolder &holder) const {
+    ChessSquare* square = static_cast<ChessSquare*>(&holder);
+    return (7 - square->getRow()) * 8 + square->getColumn();
+}
+
+ChessSquare* Chess::holderFor(int square) const {
+    return _grid->getSquare(square % 8, 7 - square / 8);
+}
+
+bool Chess::findMove(int from, int to, ChessMove &move) const {
+    ChessPosition::Moves moves;
+    _position.moves(moves);
+    // promotions are listed queen first, so the first match is the one we want
+    for (const ChessMove &candidate : moves) {
+        if (candidate.from() == from && candidate.to() == to) {
+            move = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Chess::makeMove(const ChessMove &move, bool pieceMoved) {
+    // a dragged piece is already on its new square, the AI's still needs to slide there
+    if (!pieceMoved) {
+        ChessSquare* src = holderFor(move.from());
+        ChessSquare* dst = holderFor(move.to());
+        Bit* bit = src->bit();
+        dst->setBit(bit);
+        bit->moveTo(dst->getPosition());
+        src->setBit(nullptr);
+    }
+    if (move.isCastle()) {
+        int rookFrom = move.kind() == ChessMove::KING_CASTLE ? move.from() + 3 : move.from() - 4;
+        int rookTo = move.kind() == ChessMove::KING_CASTLE ? move.from() + 1 : move.from() - 1;
+        ChessSquare* src = holderFor(rookFrom);
+        ChessSquare* dst = holderFor(rookTo);
+        Bit* rook = src->bit();
+        dst->setBit(rook);
+        rook->moveTo(dst->getPosition());
+        src->setBit(nullptr);
+    }
+
+    recordMove(moveCode(move), _position.moveToString(move));
+    _position.play(move);
+    // picks up en passant captures and promotions
+    syncPieces();
+    endTurn();
+}
+
+void Chess::syncPieces() {
+    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
+        int piece = _position.pieceAt((7 - y) * 8 + x);
+        Bit* bit = square->bit();
+        int tag = ChessPosition::pieceType(piece) + (ChessPosition::pieceColor(piece) == BLACK_PLAYER ? 128 : 0);
+        if (bit && (piece == ChessPosition::EMPTY || bit->gameTag() != tag)) {
+            square->destroyBit();
+            bit = nullptr;
+        }
+        if (piece != ChessPosition::EMPTY && !bit) {
+            Bit* newPiece = createPiece(piece);
+            newPiece->setPosition(square->getPosition());
+            square->setBit(newPiece);
+        }
+    });
+}
+
+bool Chess::actionForEmptyHolder(BitHolder &holder) {
+    return false; // Chess doesn't place new pieces
+}
+
+bool Chess::canBitMoveFrom(Bit &bit, BitHolder &src) {
+    if (!src.bit() || bit.getOwner() != getCurrentPlayer()) return false;
+
+    int square = squareFor(src);
+    ChessPosition::Moves moves;
+    _position.moves(moves);
+    for (const ChessMove &move : moves) {
+        if (move.from() == square) return true;
+    }
+    return false;
+}
+
+bool Chess::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
+    ChessMove move;
+    return findMove(squareFor(src), squareFor(dst), move);
+}
+
+void Chess::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
+    ChessMove move;
+    if (!findMove(squareFor(src), squareFor(dst), move)) return;
+    makeMove(move, true);
+}
+
+Player* Chess::checkForWinner() {
+    int winner = _position.winner();
+    return winner < 0 ? nullptr : getPlayerAt(winner);
+}
+
+bool Chess::checkForDraw() {
+    return _position.gameOver() && _position.winner() < 0;
+}
+
+void Chess::stopGame() {
+    _searcher.cancel();
+    _grid->forEachSquare([](ChessSquare* square, int x, int y) {
+        square->destroyBit();
+    });
+    _bitPool.reset();
+    _position.reset();
+}
+
+std::string Chess::initialStateString() {
+    return ChessPosition().stateString();
+}
+
+std::string Chess::stateString() {
+    return _position.stateString();
+}
+
+void Chess::setStateString(const std::string &s) {
+    _searcher.cancel();
+    if (!_position.setStateString(s)) return;
+
+    // FEN says whose turn it is, bring the game's turn into line with it
+    if (_position.sideToMove() != getCurrentPlayer()->playerNumber()) {
+        _gameOptions.currentTurnNo++;
+    }
+    syncPieces();
+    restartRecord(_position.sideToMove());
+}
+
+void Chess::updateAI() {
+    if (!gameHasAI() || _position.gameOver()) return;
+
+    SearchLimits limits;
+    limits.depth = getAIMAXDepth();
+    limits.movetime = getAIMoveTime();
+    SearchResult<ChessPosition> result;
+    if (_gameOptions.AISliceMicroseconds > 0) {
+        if (!_searcher.running()) {
+            _searcher.start(_position, limits);
+        }
+        // not done yet, the search waits where it stopped until next frame
+        if (!_searcher.resume(_gameOptions.AISliceMicroseconds)) return;
+        result = _searcher.result();
+    } else {
+        _searcher.cancel();
+        // search a copy so the board we draw from is never mid-search
+        ChessPosition position = _position;
+        result = _searcher.search(position, limits);
+    }
+    if (!result.found) return;
+    makeMove(result.bestMove, false);
+}
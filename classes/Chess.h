@@ -0,0 +1,61 @@
+#pragma once
+#include "Game.h"
+#include "../core/ChessPosition.h"
+#include "../core/ChessSearch.h"
+#include "../core/SlicedSearch.h"
+
+//
+// chess, the rules and AI live in ChessPosition, this class moves the sprites to match
+// white is player 0 at the bottom of the board, pawns dragged to the last rank become queens
+//
+class Chess : public Game
+{
+public:
+    Chess();
+    ~Chess();
+
+    // Required virtual methods from Game base class
+    void        setUpBoard() override;
+    Player*     checkForWinner() override;
+    bool        checkForDraw() override;
+    std::string initialStateString() override;
+    std::string stateString() override;
+    void        setStateString(const std::string &s) override;
+    bool        actionForEmptyHolder(BitHolder &holder) override;
+    bool        canBitMoveFrom(Bit &bit, BitHolder &src) override;
+    bool        canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
+    void        stopGame() override;
+    void        bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
+
+    // AI methods
+    void        updateAI() override;
+    bool        gameHasAI() override { return true; }
+    bool        gameCanTimeSlice() override { return true; }
+    Grid* getGrid() override { return _grid; }
+    const SearchStats *searchStats() override { return &_searcher.stats(); }
+    int         gameRecordTitle() override { return RECORD_CHESS; }
+
+private:
+    // Player constants
+    static const int WHITE_PLAYER = 0;
+    static const int BLACK_PLAYER = 1;
+
+    // Helper methods
+    Bit*        createPiece(int piece);
+    // the position counts ranks from the bottom, the grid counts rows from the top
+    int         squareFor(BitHolder &holder) const;
+    ChessSquare* holderFor(int square) const;
+    // the legal move from one square to another, promotions pick the queen
+    bool        findMove(int from, int to, ChessMove &move) const;
+    // play move on the position, sliding the piece and any castling rook across
+    void        makeMove(const ChessMove &move, bool pieceMoved);
+    // add, remove and promote pieces until the board matches the position
+    void        syncPieces();
+
+    // Board representation
+    Grid*       _grid;
+    ChessPosition _position;
+    // kept between moves so its transposition table carries over, searches a move at once or over frames
+    // when AISliceMicroseconds is set
+    SlicedSearcher<ChessPosition> _searcher;
+};
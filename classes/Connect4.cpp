@@ -1,11 +1,15 @@
 #include "Connect4.h"
+#include <cmath>
 
-Connect4::Connect4() : Game() {
-    _grid = new Grid(7, 6);
-    _mustContinueJumping = false;
-    _jumpingPiece = nullptr;
-    _redPieces = 21;
-    _yellowPieces = 21;
+// time for a piece to fall the full height of a column
+static const float kDropSeconds = 0.6f;
+// how deep analysis mode looks, every column gets an exact score so it costs more than a move's search
+static const int kAnalysisDepth = 12;
+
+Connect4::Connect4(Engine engine) : Game(), _engine(engine), _thinking(false), _playoutRate(0.0), _ponderHash(0), _drawnAnalysis(0) {
+    // what the analysis finds is there for the AI's next search, and the other way round
+    _analysis.shareTable(_searcher.table());
+    _grid = new Grid(Connect4Position::WIDTH, Connect4Position::HEIGHT);
 }
 
 Connect4::~Connect4() {
@@ -14,453 +18,249 @@ Connect4::~Connect4() {
 
 void Connect4::setUpBoard() {
     setNumberOfPlayers(2);
-    _gameOptions.rowX = 7;
-    _gameOptions.rowY = 6;
+    _gameOptions.rowX = Connect4Position::WIDTH;
+    _gameOptions.rowY = Connect4Position::HEIGHT;
+    _gameOptions.AIMAXDepth = 6;
+    _gameOptions.AIMoveTime = _engine == MONTE_CARLO ? 1000 : 0;
+    _gameOptions.AIPonder = true;
 
     // Initialize all squares
     _grid->initializeSquares(75, "square.png");
+    _position.reset();
+
+    if (gameHasAI()) {
+        setAIPlayer(AI_PLAYER);
+    }
+
     startGame();
 }
 
-Bit* Connect4::createPiece(int pieceType) {
-    Bit* bit = new Bit();
-    bool isRed = (pieceType == RED_PIECE || pieceType == RED_KING);
-    bit->LoadTextureFromFile(isRed ? "red.png" : "yellow.png");
-    bit->setOwner(getPlayerAt(isRed ? RED_PLAYER : YELLOW_PLAYER));
-    bit->setGameTag(pieceType);
-    if (pieceType == RED_KING || pieceType == YELLOW_KING)
-        bit->setScale(1.3f);
+Bit* Connect4::createPiece(int playerNumber) {
+    Bit* bit = _bitPool.allocate();
+    bit->LoadTextureFromFile(playerNumber == YELLOW_PLAYER ? "yellow.png" : "red.png");
+    bit->setOwner(getPlayerAt(playerNumber));
+    bit->setGameTag(playerNumber + 1);
     return bit;
 }
 
-bool Connect4::actionForEmptyHolder(BitHolder &holder) {
-
-    // make sure we are only touching top row
-    if(holder.getPosition().y > _grid->getSquareByIndex(0)->getPosition().y)
-        return false;
-
-    int currPlayerNum = getCurrentPlayer()->playerNumber();
-    Bit* piece = createPiece(currPlayerNum); //depending on turn create a new piece
-    
-    // we need to look for the most available holder in that column
-    // get the x value of clicked holder, loop through grid x column checking for holder.empty
-    BitHolder *appropriateHolder = &holder;
-    ChessSquare *c = (ChessSquare*)appropriateHolder;
-    currPlayerNum == 0 ? 
-        _yellowPieces-- :
-        _redPieces--; // reduce peicez after each turmb
-    appropriateHolder->setGameTag(currPlayerNum); // so we knbow which color is in holder yellow = 0, red = 1
-    std::cout << "Curr GameTag for index" << _grid->getIndex(appropriateHolder->getPosition().x, appropriateHolder->getPosition().y) << " is " << appropriateHolder->gameTag() << std::endl;
-    int xValue = c->getColumn();
-    for (int i = _grid->getHeight() - 1; i > 0; i--) // start from bottom to up 
-    {
-        BitHolder *h = _grid->getSquare(xValue, i); 
-        if (h->empty()) //find first empty spot
-        {
-            h->setGameTag(currPlayerNum);
-            appropriateHolder = h;
-            c = (ChessSquare*)h;
-            break;
-        }
-
-
-    }
-    piece->setPosition(appropriateHolder->getPosition()); 
-    appropriateHolder->setBit(piece);
-    lastBitCreated = piece;
+//
+// the position counts rows from the bottom, the grid from the top
+//
+ChessSquare* Connect4::squareFor(int column, int row) const {
+    return _grid->getSquare(column, Connect4Position::HEIGHT - 1 - row);
+}
 
-    // No need to handle connections here anymore as we check for winning lines directly
+//
+// play column on the position and drop a piece in from the top of the column to match
+//
+void Connect4::dropPiece(int column) {
+    int row = _position.landingRow(column);
+    ChessSquare* target = squareFor(column, row);
+    ChessSquare* top = _grid->getSquare(column, 0);
+
+    Bit* piece = createPiece(_position.sideToMove());
+    piece->setPosition(top->getPosition());
+    target->setBit(piece);
+    // falling further takes longer like it would under gravity
+    float rowsFallen = (float)(target->getRow() - top->getRow());
+    piece->moveTo(target->getPosition(), kDropSeconds * std::sqrt(rowsFallen / (Connect4Position::HEIGHT - 1)), Easing::EaseOutBounce);
+
+    recordMove(moveCode(column), _position.moveToString(column));
+    _position.play(column);
     endTurn();
-    return false; // Checkers doesn't place new pieces
 }
 
-bool Connect4::canBitMoveFrom(Bit &bit, BitHolder &src) {
-    if (!src.bit() || bit.getOwner() != getCurrentPlayer()) return false;
-    if (_mustContinueJumping && &src != _jumpingPiece) return false;
-
-    ChessSquare* square = static_cast<ChessSquare*>(&src);
-    int x = square->getColumn();
-    int y = square->getRow();
-
-    // Must jump if available
-    if (hasJumpAvailable(bit.getOwner())) {
-        return canJumpFrom(*square);
+bool Connect4::actionForEmptyHolder(BitHolder &holder) {
+    // pieces go in from the top row
+    ChessSquare* square = static_cast<ChessSquare*>(&holder);
+    if (square->getRow() != 0 || !_position.canPlay(square->getColumn())) {
+        return false;
     }
+    dropPiece(square->getColumn());
     return true;
 }
 
-bool Connect4::canBitMoveFromTo(Bit& bit, BitHolder& src, BitHolder& dst) {
-    if (!src.bit() || dst.bit()) return false;
-
-    ChessSquare* srcSquare = static_cast<ChessSquare*>(&src);
-    ChessSquare* dstSquare = static_cast<ChessSquare*>(&dst);
-
-    int srcX = srcSquare->getColumn();
-    int srcY = srcSquare->getRow();
-
-    if (!_grid->isEnabled(dstSquare->getColumn(), dstSquare->getRow())) return false;
-
-    bool isKing = (bit.gameTag() == RED_KING || bit.gameTag() == YELLOW_KING);
-    bool isRed = (bit.getOwner() == getPlayerAt(RED_PLAYER));
-
-    // Simple moves (if no jumps required)
-    if (!_mustContinueJumping && !hasJumpAvailable(bit.getOwner())) {
-        if (isKing) {
-            return dstSquare == _grid->getFL(srcX, srcY) || dstSquare == _grid->getFR(srcX, srcY) ||
-                   dstSquare == _grid->getBL(srcX, srcY) || dstSquare == _grid->getBR(srcX, srcY);
-        }
-        return isRed ? (dstSquare == _grid->getBL(srcX, srcY) || dstSquare == _grid->getBR(srcX, srcY)) :
-                       (dstSquare == _grid->getFL(srcX, srcY) || dstSquare == _grid->getFR(srcX, srcY));
-    }
-
-    // Jump moves
-    if (_mustContinueJumping && &src != _jumpingPiece) return false;
-
-    // Check all jump directions
-    auto checkJump = [&](ChessSquare* middle, ChessSquare* target) -> bool {
-        if (!middle || !target || !middle->bit()) return false;
-        if (middle->bit()->getOwner() == bit.getOwner()) return false;
-        return dstSquare == target;
-    };
-
-    if (isKing || !isRed) {
-        if (checkJump(_grid->getFL(srcX, srcY), _grid->getFLFL(srcX, srcY))) return true;
-        if (checkJump(_grid->getFR(srcX, srcY), _grid->getFRFR(srcX, srcY))) return true;
-    }
-    if (isKing || isRed) {
-        if (checkJump(_grid->getBL(srcX, srcY), _grid->getBLBL(srcX, srcY))) return true;
-        if (checkJump(_grid->getBR(srcX, srcY), _grid->getBRBR(srcX, srcY))) return true;
-    }
-
-    return false;
-}
-
-void Connect4::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
-    ChessSquare* srcSquare = static_cast<ChessSquare*>(&src);
-    ChessSquare* dstSquare = static_cast<ChessSquare*>(&dst);
-
-    int srcX = srcSquare->getColumn();
-    int srcY = srcSquare->getRow();
-    int dstX = dstSquare->getColumn();
-    int dstY = dstSquare->getRow();
-
-    // Check for jump
-    ChessSquare* jumped = nullptr;
-    if (dstSquare == _grid->getFLFL(srcX, srcY)) jumped = _grid->getFL(srcX, srcY);
-    else if (dstSquare == _grid->getFRFR(srcX, srcY)) jumped = _grid->getFR(srcX, srcY);
-    else if (dstSquare == _grid->getBLBL(srcX, srcY)) jumped = _grid->getBL(srcX, srcY);
-    else if (dstSquare == _grid->getBRBR(srcX, srcY)) jumped = _grid->getBR(srcX, srcY);
-
-    if (jumped && jumped->bit()) {
-        // Capture
-        (jumped->bit()->getOwner() == getPlayerAt(RED_PLAYER)) ? _redPieces-- : _yellowPieces--;
-        jumped->destroyBit();
-
-        // Promotion check
-        if ((bit.gameTag() == RED_PIECE && dstY == 7) || (bit.gameTag() == YELLOW_PIECE && dstY == 0)) {
-            bit.setGameTag(bit.gameTag() == RED_PIECE ? RED_KING : YELLOW_KING);
-            bit.setScale(1.3f);
-        }
-
-        // Check for more jumps
-        if (canJumpFrom(*dstSquare)) {
-            _mustContinueJumping = true;
-            _jumpingPiece = &dst;
-            return;
-        }
-    } else {
-        // Regular move - promotion check
-        if ((bit.gameTag() == RED_PIECE && dstY == 7) || (bit.gameTag() == YELLOW_PIECE && dstY == 0)) {
-            bit.setGameTag(bit.gameTag() == RED_PIECE ? RED_KING : YELLOW_KING);
-            bit.setScale(1.3f);
-        }
-    }
-
-    _mustContinueJumping = false;
-    _jumpingPiece = nullptr;
-    endTurn();
-}
-
-bool Connect4::canJumpFrom(ChessSquare& square) const {
-    Bit* piece = square.bit();
-    if (!piece) return false;
-
-    int x = square.getColumn();
-    int y = square.getRow();
-    bool isKing = (piece->gameTag() == RED_KING || piece->gameTag() == YELLOW_KING);
-    bool isRed = (piece->getOwner() == getPlayerAt(RED_PLAYER));
-    Player* player = piece->getOwner();
-
-    auto checkJumpDir = [&](ChessSquare* middle, ChessSquare* target) -> bool {
-        return middle && middle->bit() && middle->bit()->getOwner() != player &&
-               target && !target->bit();
-    };
-
-    if (isKing || !isRed) {
-        if (checkJumpDir(_grid->getFL(x, y), _grid->getFLFL(x, y))) return true;
-        if (checkJumpDir(_grid->getFR(x, y), _grid->getFRFR(x, y))) return true;
-    }
-    if (isKing || isRed) {
-        if (checkJumpDir(_grid->getBL(x, y), _grid->getBLBL(x, y))) return true;
-        if (checkJumpDir(_grid->getBR(x, y), _grid->getBRBR(x, y))) return true;
-    }
-    return false;
+bool Connect4::canBitMoveFrom(Bit &bit, BitHolder &src) {
+    return false; // pieces stay where they land
 }
 
-bool Connect4::hasJumpAvailable(Player* player) const {    
-    return false;
+bool Connect4::canBitMoveFromTo(Bit& bit, BitHolder& src, BitHolder& dst) {
+    return false; // pieces stay where they land
 }
 
 Player* Connect4::checkForWinner() {
-    ChessSquare* currentHolder = (ChessSquare*)lastBitCreated->getHolder();
-    
-    // Check for winning lines in any direction
-    auto connectedSquares = _grid->getConnectedSquares(currentHolder->getColumn(), currentHolder->getRow());
-    if (!connectedSquares.empty()) {
-        return getPlayerAt(!(getCurrentTurnNo()%2));
-    }
-    return nullptr;
+    int winner = _position.winner();
+    return winner < 0 ? nullptr : getPlayerAt(winner);
 }
 
 bool Connect4::checkForDraw() {
-    return _yellowPieces <= 0 && _redPieces <= 0 && !checkForWinner();
+    return _position.gameOver() && _position.winner() < 0;
 }
 
 void Connect4::stopGame() {
+    _ponder.stop();
+    _analysis.stop();
+    _slicedSearcher.cancel();
+    _thinking = false;
     _grid->forEachSquare([](ChessSquare* square, int x, int y) {
         square->destroyBit();
     });
-    _mustContinueJumping = false;
-    _jumpingPiece = nullptr;
-    _redPieces = 21;
-    _yellowPieces = 21;
+    _bitPool.reset();
+    _position.reset();
+    _mcts.reset();
 }
 
 std::string Connect4::initialStateString() {
-    return "0000000000000000000000000000000000000000000000000"; 
-    // we are fricking using bits for this, very low level so we ai can be more performant
+    return Connect4Position().stateString();
 }
 
 std::string Connect4::stateString() {
-    return _grid->getStateString();
+    return _position.stateString();
 }
 
 void Connect4::setStateString(const std::string &s) {
-    if (s.length() != 42) return; // make sure it is an appropriate size for the board
-
-    _redPieces = 0;
-    _yellowPieces = 0;
-
-    _grid->setStateString(s);
+    _ponder.stop();
+    _slicedSearcher.cancel();
+    _thinking = false;
+    if (!_position.setStateString(s)) return; // make sure it is a legal board
 
     // Recreate pieces from state
-    size_t index = 0;
-    _grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
-        if (index < s.length()) {
-            int pieceType = s[index++] - '0';
-            if (pieceType != 0) {
-                Bit* piece = createPiece(pieceType);
-                piece->setPosition(square->getPosition());
-                square->setBit(piece);
-                (pieceType == RED_PIECE || pieceType == RED_KING) ? _redPieces++ : _yellowPieces++;
-            }
+    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
+        square->destroyBit();
+        int player = _position.pieceAt(x, Connect4Position::HEIGHT - 1 - y);
+        if (player >= 0) {
+            Bit* piece = createPiece(player);
+            piece->setPosition(square->getPosition());
+            square->setBit(piece);
         }
     });
+    restartRecord(_position.sideToMove());
 }
 
-void Connect4::updateAI() {
-    // Constants for alpha-beta algorithm
-    const int MAX_DEPTH = 6;
-    const int INFINITY_SCORE = 1000000;
-
-    // Helper function to evaluate a line of 4 squares
-    auto evaluateLine = [this](std::vector<ChessSquare*>& line) -> int {
-        int aiCount = 0;
-        int playerCount = 0;
-        int empty = 0;
-        
-        for (ChessSquare* square : line) {
-            if (!square || !square->bit()) {
-                empty++;
-            } else {
-                if (square->gameTag() == getCurrentPlayer()->playerNumber()) {
-                    aiCount++;
-                } else {
-                    playerCount++;
-                }
-            }
-        }
-        
-        // If both players have pieces in the line, it's not valuable
-        if (aiCount > 0 && playerCount > 0) return 0;
-        
-        // Score based on number of pieces
-        auto getScore = [](int count, int empty) -> int {
-            switch(count) {
-                case 4: return 1000000;  // Winning position
-                case 3: return empty > 0 ? 100 : 0;  // Three in a row with space
-                case 2: return empty > 1 ? 10 : 0;   // Two in a row with spaces
-                case 1: return empty > 2 ? 1 : 0;    // One with spaces
-                default: return 0;
-            }
-        };
-        
-        if (aiCount > 0) return getScore(aiCount, empty);
-        if (playerCount > 0) return -getScore(playerCount, empty);
-        return 0;
-    };
+void Connect4::drawFrame() {
+    Game::drawFrame();
+    if (!gameCanAnalyse() || !_gameOptions.AIAnalysis) {
+        _analysis.stop();
+        return;
+    }
+    // a new state string means a new position to score, anything else carries on deepening
+    _analysis.update(stateString(), _position, kAnalysisDepth);
+    _drawnAnalysis = _analysis.version();
+    std::vector<Analysis<Connect4Position>::Line> lines = _analysis.lines();
+    for (size_t i = 0; i < lines.size(); i++) {
+        // over the top square of the column
+        drawScoreLabel(_grid->getSquare(lines[i].move, 0)->getPosition(), Analysis<Connect4Position>::scoreLabel(lines[i].score), i == 0);
+    }
+}
 
-    // Get all possible lines of 4 squares
-    auto getAllLines = [this]() -> std::vector<std::vector<ChessSquare*>> {
-        std::vector<std::vector<ChessSquare*>> lines;
-        
-        // Horizontal lines
-        for (int y = 0; y < _grid->getHeight(); y++) {
-            for (int x = 0; x <= _grid->getWidth() - 4; x++) {
-                std::vector<ChessSquare*> line;
-                for (int i = 0; i < 4; i++) {
-                    line.push_back(_grid->getSquare(x + i, y));
-                }
-                lines.push_back(line);
-            }
-        }
-        
-        // Vertical lines
-        for (int x = 0; x < _grid->getWidth(); x++) {
-            for (int y = 0; y <= _grid->getHeight() - 4; y++) {
-                std::vector<ChessSquare*> line;
-                for (int i = 0; i < 4; i++) {
-                    line.push_back(_grid->getSquare(x, y + i));
-                }
-                lines.push_back(line);
-            }
+void Connect4::updateAI() {
+    if (_position.gameOver()) return;
+    // the ponder search shares the searchers, it has to be finished before anything else touches them
+    _ponder.stop();
+
+    int column = -1;
+    std::vector<int> pv;
+    int slice = _gameOptions.AISliceMicroseconds;
+    if (_engine == MONTE_CARLO) {
+        // tree parallel on every core, or just the render thread when time sliced
+        int threads = slice > 0 ? 1 : Scheduler::shared().threads();
+        if (_mcts.threads() != threads) {
+            _mcts.setThreads(threads);
         }
-        
-        // Diagonal lines (bottom-left to top-right)
-        for (int y = 3; y < _grid->getHeight(); y++) {
-            for (int x = 0; x <= _grid->getWidth() - 4; x++) {
-                std::vector<ChessSquare*> line;
-                for (int i = 0; i < 4; i++) {
-                    line.push_back(_grid->getSquare(x + i, y - i));
-                }
-                lines.push_back(line);
+        MctsLimits limits;
+        limits.movetime = getAIMoveTime();
+        // a reply that was pondered on may already have all the playouts a move's time would buy
+        limits.rootPlayouts = (uint64_t)(_playoutRate * getAIMoveTime() / 1000.0);
+        if (slice > 0) {
+            if (!_thinking) {
+                _thinking = true;
+                _thinkingSince = std::chrono::steady_clock::now();
             }
+            limits.movetime = (slice + 999) / 1000;
+            limits.rootPlayouts = 0;
         }
-        
-        // Diagonal lines (top-left to bottom-right)
-        for (int y = 0; y <= _grid->getHeight() - 4; y++) {
-            for (int x = 0; x <= _grid->getWidth() - 4; x++) {
-                std::vector<ChessSquare*> line;
-                for (int i = 0; i < 4; i++) {
-                    line.push_back(_grid->getSquare(x + i, y + i));
-                }
-                lines.push_back(line);
-            }
+        MctsResult<Connect4Position> result = _mcts.search(_position, limits);
+        if (result.playouts > 1000) {
+            _playoutRate = result.playoutsPerSecond();
         }
-        
-        return lines;
-    };
-
-    // Evaluate current board position
-    auto evaluatePosition = [&]() -> int {
-        int score = 0;
-        auto lines = getAllLines();
-        for (auto& line : lines) {
-            score += evaluateLine(line);
+        _aiStats = _mcts.stats();
+        if (slice > 0) {
+            // the tree stays put between calls on the same position, so each slice adds to it
+            int64_t thought = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _thinkingSince).count();
+            if (thought < getAIMoveTime()) return;
+            _thinking = false;
         }
-        return score;
-    };
-
-    // Make temporary move
-    auto makeTemporaryMove = [this](int column, int playerNum) -> bool {
-        for (int y = _grid->getHeight() - 1; y >= 0; y--) {
-            ChessSquare* square = _grid->getSquare(column, y);
-            if (square && !square->bit()) {
-                square->setGameTag(playerNum);
-                return true;
-            }
+        if (result.found) {
+            column = result.bestMove;
         }
-        return false;
-    };
-
-    // Undo temporary move
-    auto undoTemporaryMove = [this](int column) {
-        for (int y = 0; y < _grid->getHeight(); y++) {
-            ChessSquare* square = _grid->getSquare(column, y);
-            if (square && square->gameTag() != -1) {
-                square->setGameTag(-1);
-                break;
-            }
+    } else if (slice > 0) {
+        if (!_slicedSearcher.running()) {
+            SearchLimits limits;
+            limits.depth = getAIMAXDepth();
+            limits.movetime = getAIMoveTime();
+            _slicedSearcher.start(_position, limits);
         }
-    };
-
-    // Get valid moves
-    auto getValidMoves = [this]() -> std::vector<int> {
-        std::vector<int> moves;
-        for (int x = 0; x < _grid->getWidth(); x++) {
-            if (!_grid->getSquare(x, 0)->bit()) {
-                moves.push_back(x);
-            }
+        // not done yet, the search waits where it stopped until next frame
+        if (!_slicedSearcher.resume(slice)) return;
+        _aiStats = _slicedSearcher.stats();
+        const SearchResult<Connect4Position> &result = _slicedSearcher.result();
+        if (result.found) {
+            column = result.bestMove;
+            pv = result.pv;
         }
-        return moves;
-    };
-
-    // Alpha-beta algorithm
-    std::function<int(int, int, int, bool)> alphaBeta = [&](int depth, int alpha, int beta, bool maximizingPlayer) -> int {
-        if (depth == 0) return evaluatePosition();
-        
-        auto validMoves = getValidMoves();
-        if (validMoves.empty()) return 0;
-        
-        if (maximizingPlayer) {
-            int maxEval = -INFINITY_SCORE;
-            for (int column : validMoves) {
-                if (makeTemporaryMove(column, getCurrentPlayer()->playerNumber())) {
-                    int eval = alphaBeta(depth - 1, alpha, beta, false);
-                    undoTemporaryMove(column);
-                    maxEval = std::max(maxEval, eval);
-                    alpha = std::max(alpha, eval);
-                    if (beta <= alpha) break;
-                }
-            }
-            return maxEval;
-        } else {
-            int minEval = INFINITY_SCORE;
-            for (int column : validMoves) {
-                if (makeTemporaryMove(column, !getCurrentPlayer()->playerNumber())) {
-                    int eval = alphaBeta(depth - 1, alpha, beta, true);
-                    undoTemporaryMove(column);
-                    minEval = std::min(minEval, eval);
-                    beta = std::min(beta, eval);
-                    if (beta <= alpha) break;
-                }
-            }
-            return minEval;
+    } else if (_ponderHash == _position.hash() && _ponderResult.found && _ponderResult.depth >= getAIMAXDepth()) {
+        // the human played the reply we expected and pondering already searched it deep enough
+        column = _ponderResult.bestMove;
+        pv = _ponderResult.pv;
+        _aiStats = _searcher.stats();
+    } else {
+        _slicedSearcher.cancel();
+        // search a copy so the board we draw from is never mid-search
+        Connect4Position position = _position;
+        SearchLimits limits;
+        limits.depth = getAIMAXDepth();
+        SearchResult<Connect4Position> result = _searcher.search(position, limits);
+        _aiStats = _searcher.stats();
+        if (result.found) {
+            column = result.bestMove;
+            pv = result.pv;
         }
-    };
+    }
+    if (column < 0) return;
+    dropPiece(column);
+    startPondering(pv);
+}
 
-    // Find and make the best move
-    auto validMoves = getValidMoves();
-    int bestMove = validMoves[0];
-    int bestScore = -INFINITY_SCORE;
-    bool isMaximizingPlayer = true;
-    
-    for (int column : validMoves) {
-        if (makeTemporaryMove(column, getCurrentPlayer()->playerNumber())) {
-            int score = alphaBeta(MAX_DEPTH - 1, -INFINITY_SCORE, INFINITY_SCORE, !isMaximizingPlayer);
-            undoTemporaryMove(column);
-            
-            if (score > bestScore) {
-                bestScore = score;
-                bestMove = column;
-            }
-        }
+//
+// alpha-beta ponders the position after the reply its last line expects, searching as deep as it gets
+// monte carlo keeps growing the tree under every reply, the next search picks up whichever comes
+//
+void Connect4::startPondering(const std::vector<int> &pv) {
+    _ponderHash = 0;
+    _ponderResult = SearchResult<Connect4Position>();
+    if (!gameCanPonder() || !_gameOptions.AIPonder || _gameOptions.AIvsAI || _position.gameOver() || getCurrentPlayer()->isAIPlayer()) return;
+
+    Connect4Position position = _position;
+    if (_engine == MONTE_CARLO) {
+        _ponder.start([this, position](const std::atomic<bool> &stop) {
+            MctsLimits limits;
+            limits.stop = &stop;
+            _mcts.search(position, limits);
+        });
+        return;
     }
-    
-    // Make the best move
-    BitHolder* holder = _grid->getSquare(bestMove, 0);
-    if (holder) {
-        actionForEmptyHolder(*holder);
+    // pv starts with the move just played, with no reply after it searching for the human still fills the table for all of them
+    bool predicted = pv.size() >= 2 && position.canPlay(pv[1]);
+    if (predicted) {
+        position.play(pv[1]);
+        _ponderHash = position.hash();
     }
+    _ponder.start([this, position, predicted](const std::atomic<bool> &stop) mutable {
+        SearchLimits limits;
+        limits.stop = &stop;
+        SearchResult<Connect4Position> result = _searcher.search(position, limits);
+        if (predicted) {
+            _ponderResult = result;
+        }
+    });
 }
-
@@ -1,13 +1,22 @@
 #pragma once
 #include "Game.h"
+#include "../core/Connect4Position.h"
+#include "../core/Analysis.h"
+#include "../core/MCTS.h"
+#include "../core/Ponder.h"
+#include "../core/Search.h"
+#include "../core/SlicedSearch.h"
 
-// NOTE: If Square class needs modifications to support colored squares for checkerboard pattern,
-// add a method like setColor(ImVec4 color) to Square class
-
+//
+// connect 4, the rules and AI live in Connect4Position, this class keeps the sprites in step with it
+//
 class Connect4 : public Game
 {
 public:
-    Connect4();
+    // which AI plays, alpha-beta to a fixed depth or monte carlo for a fixed time
+    enum Engine { ALPHA_BETA, MONTE_CARLO };
+
+    Connect4(Engine engine = ALPHA_BETA);
     ~Connect4();
 
     // Required virtual methods from Game base class
@@ -21,46 +30,56 @@ public:
     bool        canBitMoveFrom(Bit &bit, BitHolder &src) override;
     bool        canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
     void        stopGame() override;
-    void        bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
+    // draws the analysis scores over the columns on top of the board
+    void        drawFrame() override;
 
     // AI methods
     void        updateAI() override;
-    bool        gameHasAI() override { return false; } // Set to true when AI is implemented
+    bool        gameHasAI() override { return true; }
+    // pondering needs a thread, a time sliced AI is for builds that can't have one
+    bool        gameCanPonder() override { return _gameOptions.AISliceMicroseconds == 0; }
+    bool        gameCanTimeSlice() override { return true; }
+    bool        gameCanAnalyse() override { return _gameOptions.AISliceMicroseconds == 0; }
+    bool        needsFrames() override { return _gameOptions.AIAnalysis && (_analysis.searching() || _analysis.version() != _drawnAnalysis); }
     Grid* getGrid() override { return _grid; }
+    const SearchStats *searchStats() override { return &_aiStats; }
+    int         gameRecordTitle() override { return RECORD_CONNECT4; }
 
 private:
-    // Constants for piece types
-    static const int EMPTY = 0;
-    static const int RED_PIECE = 1;
-    static const int RED_KING = 2;
-    static const int YELLOW_PIECE = 2;
-    static const int YELLOW_KING = 4;
-
-    // Player constants
-    static const int RED_PLAYER = 0;
-    static const int YELLOW_PLAYER = 1;
-
-    Bit* lastBitCreated;
+    // Player constants, yellow drops first
+    static const int YELLOW_PLAYER = 0;
+    static const int RED_PLAYER = 1;
 
     // Helper methods
-    Bit*        createPiece(int pieceType);
-    int         getPieceType(const Bit& bit) const;
-    bool        isKing(const Bit& bit) const;
-    bool        isValidMove(int srcX, int srcY, int dstX, int dstY, Player* player) const;
-    bool        isJumpMove(int srcX, int srcY, int dstX, int dstY) const;
-    bool        hasJumpAvailable(Player* player) const;
-    bool        canJumpFrom(ChessSquare& square) const;
-    void        performJump(int srcX, int srcY, int dstX, int dstY);
-    void        promoteToKing(Bit& bit, int y);
-    void        getBoardPosition(BitHolder &holder, int &x, int &y) const;
-    bool        isValidSquare(int x, int y) const;
+    Bit*        createPiece(int playerNumber);
+    ChessSquare* squareFor(int column, int row) const;
+    void        dropPiece(int column);
+    // keep searching on the human's turn, pv is the line the AI's move came from
+    void        startPondering(const std::vector<int> &pv);
 
     // Board representation
-    Grid*        _grid;
-
-    // Game state
-    bool        _mustContinueJumping;
-    BitHolder*  _jumpingPiece;
-    int         _redPieces;
-    int         _yellowPieces;
-};
\ No newline at end of file
+    Grid*       _grid;
+    Connect4Position _position;
+    // kept between moves so its transposition table carries over
+    Searcher<Connect4Position> _searcher;
+    // keeps its tree between moves so the reply that was played starts with its playouts
+    Mcts<Connect4Position> _mcts;
+    // the same search spread over frames when AISliceMicroseconds is set
+    SlicedSearcher<Connect4Position> _slicedSearcher;
+    Engine      _engine;
+    // a time sliced monte carlo move keeps growing its tree a slice a frame until its time is up
+    bool        _thinking;
+    std::chrono::steady_clock::time_point _thinkingSince;
+    // playouts a second the last monte carlo search managed, to tell when a pondered tree is already big enough
+    double      _playoutRate;
+    // the AI's last search, copied so the settings window never reads stats a ponder search is writing
+    SearchStats _aiStats;
+    // the position after the reply the alpha-beta search expects, 0 when pondering every reply, and what it found there
+    uint64_t    _ponderHash;
+    SearchResult<Connect4Position> _ponderResult;
+    // every column's score for the position on the board, and the version of it last drawn
+    Analysis<Connect4Position> _analysis;
+    uint64_t    _drawnAnalysis;
+    // declared last so it stops before the searchers it uses go away
+    Ponder      _ponder;
+};
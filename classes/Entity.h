@@ -13,7 +13,9 @@ public:
     };
 
     Entity() : _entityType(EntityNone), _parent(nullptr), _retainCount(0) {};
-    Entity(EntityType type) : _entityType(type) {};
+    Entity(EntityType type) : _entityType(type), _parent(nullptr), _retainCount(0) {};
+    // destroying an entity never touches its retain count, release() is what decides when it goes
+    virtual ~Entity() {}
 
     EntityType getEntityType() {return _entityType; }
     
@@ -26,9 +28,11 @@ public:
     void removeFromParentAndCleanup(bool cleanup) {
         _parent = nullptr; 
         if (cleanup) {
-            delete this; 
+            destroy();
         }
     }
+    // how a finished entity goes away, entities that didn't come from new hand themselves back to their owner
+    virtual void destroy() { delete this; }
     // release the sprite from the list being drawn if count has reached zero
     void release() { _retainCount--; if (_retainCount <= 0) removeFromParentAndCleanup(true); }
     // release the sprite from the list being drawn
@@ -2,7 +2,10 @@
 #include "Bit.h"
 #include "BitHolder.h"
 #include "Turn.h"
+#include "Profiler.h"
+#include "../core/Trace.h"
 #include "../Application.h"
+#include <cmath>
 
 Game::Game()
 {
@@ -15,11 +18,22 @@ Game::Game()
 	_gameOptions.rowY = 0;
 	_gameOptions.score = 0;
 	_gameOptions.AIDepthSearches = 0;
+	_gameOptions.AIMAXDepth = 0;
+	_gameOptions.AIMoveTime = 0;
+	_gameOptions.AIPonder = false;
+	_gameOptions.AIAnalysis = false;
+#if defined(SINGLE_THREADED)
+	// kiosk builds keep the AI on the render thread
+	_gameOptions.AISliceMicroseconds = AI_SLICE_MICROSECONDS;
+#else
+	_gameOptions.AISliceMicroseconds = 0;
+#endif
 	_gameOptions.AIvsAI = false;
 
 	_table = nullptr;
 	_winner = nullptr;
 	_lastMove = "";
+	_recordStartSide = -1;
 	// everything else
 	_dragBit = nullptr;
 	_dragMoved = false;
@@ -85,22 +99,59 @@ void Game::startGame()
 	turn->_boardState = startState;
 	turn->_gameNumber = _gameOptions.gameNumber;
 	_gameOptions.currentTurnNo = 0;
+	restartRecord(0);
 }
 
 void Game::endTurn()
 {
+	Tracer::shared().instant("endTurn", "game");
 	_gameOptions.currentTurnNo++;
 	std::string startState = stateString();
 	Turn *turn = new Turn;
 	turn->_boardState = stateString();
+	turn->_move = _lastMove;
 	turn->_date = (int)_gameOptions.currentTurnNo;
 	turn->_score = _gameOptions.score;
 	turn->_gameNumber = _gameOptions.gameNumber;
 	_turns.push_back(turn);
-	
+
+	_lastMove.clear();
+
+	// the board changed, make sure an idle window picks it up
+	ClassGame::RequestRedraw();
 	ClassGame::EndOfTurn();
 }
 
+void Game::recordMove(uint16_t code, const std::string &text)
+{
+	_recordMoves.push_back(code);
+	// a turn can take more than one move, othello plays the pass for a player left without a move
+	_lastMove = _lastMove.empty() ? text : _lastMove + " " + text;
+}
+
+void Game::restartRecord(int sideToMove)
+{
+	std::string state = stateString();
+	bool usualStart = state == initialStateString();
+	_recordStart = usualStart ? "" : state;
+	_recordStartSide = usualStart ? -1 : sideToMove;
+	_recordMoves.clear();
+	_lastMove.clear();
+}
+
+GameRecord Game::gameRecord(int winner)
+{
+	GameRecord record;
+	record.title = (GameRecordTitle)gameRecordTitle();
+	// player 0 always moves first from the usual start, a loaded position says who moved first in startSide
+	record.result = winner < 0 ? RESULT_DRAW : (winner == 0 ? RESULT_PLAYER1 : RESULT_PLAYER2);
+	record.time = (uint64_t)std::time(nullptr);
+	record.start = _recordStart;
+	record.startSide = _recordStartSide;
+	record.moves = _recordMoves;
+	return record;
+}
+
 //
 // scan for mouse is temporarily in the actual game class
 // this will be moved to a higher up class when the squares have a heirarchy
@@ -178,7 +229,15 @@ void Game::findDropTarget(ImVec2 &pos)
 //
 void Game::drawFrame()
 {
-	scanForMouse();
+	{
+		ProfileScope scope(ProfilePhase::ScanForMouse);
+		scanForMouse();
+	}
+
+	ProfileScope scope(ProfilePhase::DrawFrame);
+
+	// advance running animations by this frame's time, a still board has none
+	Animator::shared().update(ImGui::GetIO().DeltaTime);
 
 	Grid* grid = getGrid();
 
@@ -187,37 +246,34 @@ void Game::drawFrame()
 		square->paintSprite();
 	});
 
-	//Paint pieces
+	// Paint stationary pieces
+	grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
+		Bit* bit = square->bit();
+		if (bit && !bit->getPickedUp() && !bit->getMoving())
+		{
+			bit->paintSprite();
+		}
+	});
+
+	// Paint moving and picked up pieces on top
 	grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-		Bit* bit = square->BitHolder::bit();
-		if(bit)
-			square->BitHolder::bit()->paintSprite();
+		Bit* bit = square->bit();
+		if (bit && (bit->getPickedUp() || bit->getMoving()))
+		{
+			bit->paintSprite();
+		}
 	});
+}
 
-	// // Paint stationary pieces
-	// grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-	// 	if (square->bit() && !square->bit()->getPickedUp() && !square->bit()->getMoving())
-	// 	{
-	// 		square->bit()->paintSprite();
-	// 	}
-	// });
-
-	// // Paint moving pieces
-	// grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-	// 	if (square->bit() && square->bit()->getMoving() && !square->bit()->getPickedUp())
-	// 	{
-	// 		square->bit()->update();
-	// 		square->bit()->paintSprite();
-	// 	}
-	// });
-
-	// // Paint picked up pieces
-	// grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-	// 	if (square->bit() && square->bit()->getPickedUp())
-	// 	{
-	// 		square->bit()->paintSprite();
-	// 	}
-	// });
+void Game::drawScoreLabel(const ImVec2 &location, const std::string &text, bool best)
+{
+	// sprites are placed with the cursor, so find the square on screen the same way
+	ImGui::SetCursorPos(ImVec2(location.x + 4, location.y + 4));
+	ImVec2 topLeft = ImGui::GetCursorScreenPos();
+	ImVec2 textSize = ImGui::CalcTextSize(text.c_str());
+	ImDrawList *drawList = ImGui::GetWindowDrawList();
+	drawList->AddRectFilled(topLeft, ImVec2(topLeft.x + textSize.x + 6, topLeft.y + textSize.y + 2), best ? IM_COL32(30, 120, 40, 220) : IM_COL32(0, 0, 0, 170), 3.0f);
+	drawList->AddText(ImVec2(topLeft.x + 3, topLeft.y + 1), IM_COL32(255, 255, 255, 255), text.c_str());
 }
 
 void Game::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst)
@@ -21,11 +21,16 @@
 #include "Turn.h"
 #include "Bit.h"
 #include "BitHolder.h"
+#include "BitPool.h"
 #include "Grid.h"
+#include "../core/GameRecord.h"
+#include "../core/SearchStats.h"
 
 
 const int AI_PLAYER = 1;
 const int HUMAN_PLAYER = -1;
+// how long a time sliced AI searches each frame, a quarter of a 60 fps frame
+const int AI_SLICE_MICROSECONDS = 4000;
 
 class GameTable;
 
@@ -41,6 +46,10 @@ struct GameOptions
 	int score;
 	int AIDepthSearches;
 	int AIMAXDepth;
+	int AIMoveTime;		// milliseconds the AI may think, 0 for no limit
+	bool AIPonder;		// keep searching while the human thinks, for games that can
+	int AISliceMicroseconds;	// 0 searches a whole move at once, otherwise this long each frame on the render thread
+	bool AIAnalysis;	// show the engine's score for every legal move, for games that can
 	bool AIvsAI;
 };
 
@@ -105,6 +114,21 @@ public:
 	void setAIPlayer(unsigned int playerNumber);
 	virtual int getAIDepathSearches() { return _gameOptions.AIDepthSearches; };
 	virtual int getAIMAXDepth() { return _gameOptions.AIMAXDepth; };
+	virtual int getAIMoveTime() { return _gameOptions.AIMoveTime; };
+	// true for games whose AI can search on the human's time, AIPonder turns it on and off
+	virtual bool gameCanPonder() { return false; };
+	// true for games whose AI can spread a search over frames, see AISliceMicroseconds
+	virtual bool gameCanTimeSlice() { return false; };
+	// true for games that can score every move in the background, AIAnalysis turns it on and off
+	virtual bool gameCanAnalyse() { return false; };
+	// true while what the board shows can change without any input, like an analysis that is still deepening
+	virtual bool needsFrames() { return false; };
+	// what the AI's last search cost, nullptr for games without a search
+	virtual const SearchStats *searchStats() { return nullptr; };
+	// which title finished games are recorded as, -1 for games that aren't recorded
+	virtual int gameRecordTitle() { return -1; };
+	// the game so far as a record, winner is a player number or -1 for a draw
+	GameRecord gameRecord(int winner);
 
 	// mouse functions
 	void scanForMouse();
@@ -133,6 +157,7 @@ public:
 	std::vector<Player *> _players;
 	std::vector<Turn *> _turns;
 
+	// the moves played since the last endTurn, what the next Turn records
 	std::string _lastMove;
 
 	GameOptions _gameOptions;
@@ -142,6 +167,16 @@ protected:
 	void mouseMoved(ImVec2 &location, Entity *bit);
 	void mouseUp(ImVec2 &location, Entity *bit);
 	void findDropTarget(ImVec2 &pos);
+	// a small score tag over the top left of a square, the best move's stands out
+	void drawScoreLabel(const ImVec2 &location, const std::string &text, bool best);
+	// every title calls this for each move it plays, before playing it, code is the core position's moveCode()
+	void recordMove(uint16_t code, const std::string &text);
+	// the game record starts over from the current position, startGame does this and so does loading a state
+	void restartRecord(int sideToMove);
+
+	std::string _recordStart;
+	int _recordStartSide;
+	std::vector<uint16_t> _recordMoves;
 
 	ImVec2 _dragStartPos;
 	ImVec2 _dragOffset;
@@ -151,4 +186,7 @@ protected:
 	BitHolder *_dropTarget;
 	BitHolder *_oldHolder;
 	bool _dragMoved;
+
+	// every piece on the board comes from here, stopGame resets it in one go
+	BitPool _bitPool;
 };
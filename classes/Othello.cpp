@@ -1,16 +1,26 @@
 #include "Othello.h"
 #include <iostream>
+#include <memory>
 
-// Define the 8 directions: N, NE, E, SE, S, SW, W, NW
-const int Othello::DIRECTIONS[8][2] = {
-    {0, -1}, {1, -1}, {1, 0}, {1, 1},
-    {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}
-};
+// how deep analysis mode looks, every square gets an exact score so it costs more than a move's search
+static const int kAnalysisDepth = 8;
+
+// the atlas's region for an image, or a texture of its own like any sprite gets when the atlas doesn't have it
+static TextureRegion loadRegion(const char *filename)
+{
+    std::unique_ptr<Sprite> sprite = std::make_unique<Sprite>();
+    sprite->LoadTextureFromFile(filename);
+    return sprite->getTextureRegion();
+}
 
 Othello::Othello() : Game() {
     _grid = new Grid(8, 8);
-    _consecutivePasses = 0;
     _showingHints = false;
+    _ponderHash = 0;
+    _drawnAnalysis = 0;
+    _pieceRegionsLoaded = false;
+    // what the analysis finds is there for the AI's next search, and the other way round
+    _analysis.shareTable(_searcher.table());
 }
 
 Othello::~Othello() {
@@ -21,24 +31,14 @@ void Othello::setUpBoard() {
     setNumberOfPlayers(2);
     _gameOptions.rowX = 8;
     _gameOptions.rowY = 8;
+    _gameOptions.AIMAXDepth = 4;
+    _gameOptions.AIPonder = true;
 
     _grid->initializeSquares(80, "boardsquare.png");
 
-    // Set up initial four pieces in the center
-    Player* blackPlayer = getPlayerAt(BLACK_PLAYER);
-    Player* whitePlayer = getPlayerAt(WHITE_PLAYER);
-
     // Standard Othello starting position
-    auto placePiece = [&](int x, int y, Player* player) {
-        Bit* piece = createPiece(player);
-        piece->setPosition(_grid->getSquare(x, y)->getPosition());
-        _grid->getSquare(x, y)->setBit(piece);
-    };
-
-    placePiece(3, 3, whitePlayer);  // White at (3,3)
-    placePiece(4, 4, whitePlayer);  // White at (4,4)
-    placePiece(4, 3, blackPlayer);  // Black at (4,3)
-    placePiece(3, 4, blackPlayer);  // Black at (3,4)
+    _position.reset();
+    syncPieces();
 
     if (gameHasAI()) {
         setAIPlayer(AI_PLAYER);
@@ -48,41 +48,54 @@ void Othello::setUpBoard() {
 }
 
 Bit* Othello::createPiece(Player* player) {
-    Bit* bit = new Bit();
-    bit->LoadTextureFromFile(player == getPlayerAt(BLACK_PLAYER) ? "o.png" : "x.png");
-    bit->setOwner(player);
+    // load both disc looks once, flips reuse them
+    if (!_pieceRegionsLoaded) {
+        _pieceRegions[BLACK_PLAYER] = loadRegion("o.png");
+        _pieceRegions[WHITE_PLAYER] = loadRegion("x.png");
+        _pieceRegionsLoaded = true;
+    }
+
+    Bit* bit = _bitPool.allocate();
+    bit->recolor(player, _pieceRegions[player == getPlayerAt(BLACK_PLAYER) ? BLACK_PLAYER : WHITE_PLAYER]);
     return bit;
 }
 
+void Othello::syncPieces() {
+    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
+        int player = _position.pieceAt(y * 8 + x);
+        Bit* bit = square->bit();
+        if (player < 0) {
+            if (bit) square->destroyBit();
+        } else if (!bit) {
+            Bit* piece = createPiece(getPlayerAt(player));
+            piece->setPosition(square->getPosition());
+            square->setBit(piece);
+        } else if (bit->getOwner() != getPlayerAt(player)) {
+            // a flip, same disc just turned over
+            bit->recolor(getPlayerAt(player), _pieceRegions[player]);
+        }
+    });
+}
+
 bool Othello::actionForEmptyHolder(BitHolder &holder) {
     if (holder.bit()) return false;
 
     ChessSquare* square = static_cast<ChessSquare*>(&holder);
-    int x = square->getColumn();
-    int y = square->getRow();
-    Player* currentPlayer = getCurrentPlayer();
-
-    if (!isValidMove(x, y, currentPlayer)) return false;
-
-    // Place the piece
-    Bit* newPiece = createPiece(currentPlayer);
-    newPiece->setPosition(holder.getPosition());
-    holder.setBit(newPiece);
-
-    // Flip all affected pieces
-    flipPieces(x, y, currentPlayer);
-    _consecutivePasses = 0;
-
-    // Check if next player has moves
-    Player* nextPlayer = getPlayerAt(1 - currentPlayer->playerNumber());
-    if (!hasValidMove(nextPlayer)) {
-        _consecutivePasses++;
-        if (hasValidMove(currentPlayer)) {
-            // Next player passes, current player continues
-            return true;
-        } else {
-            _consecutivePasses = 2; // Game ends
-        }
+    int move = square->getRow() * 8 + square->getColumn();
+    if (!_position.canPlay(move)) return false;
+
+    // Place the piece and flip all affected pieces
+    recordMove(moveCode(move), _position.moveToString(move));
+    _position.play(move);
+    syncPieces();
+
+    // Next player has to pass, current player continues
+    OthelloPosition::Moves replies;
+    _position.moves(replies);
+    if (replies.size() == 1 && replies[0] == OthelloPosition::PASS) {
+        recordMove(moveCode(OthelloPosition::PASS), _position.moveToString(OthelloPosition::PASS));
+        _position.play(OthelloPosition::PASS);
+        return true;
     }
 
     endTurn();
@@ -97,240 +110,129 @@ bool Othello::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
     return false; // Pieces cannot be moved in Othello
 }
 
-bool Othello::isValidMove(int x, int y, Player* player) const {
-    if (!_grid->isValid(x, y) || _grid->getSquare(x, y)->bit()) return false;
-
-    // Check if placing a piece here would flip at least one opponent piece
-    for (int i = 0; i < 8; i++) {
-        if (checkDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], player) > 0) {
-            return true;
-        }
-    }
-    return false;
-}
-
-int Othello::checkDirection(int x, int y, int dx, int dy, Player* player) const {
-    int count = 0;
-    int nx = x + dx;
-    int ny = y + dy;
-
-    if (!_grid->isValid(nx, ny)) return 0;
-
-    Bit* firstPiece = _grid->getSquare(nx, ny)->bit();
-    if (!firstPiece || firstPiece->getOwner() == player) return 0;
-
-    // Count opponent pieces in this direction
-    while (_grid->isValid(nx, ny)) {
-        Bit* piece = _grid->getSquare(nx, ny)->bit();
-        if (!piece) return 0;
-        if (piece->getOwner() == player) return count;
-        count++;
-        nx += dx;
-        ny += dy;
-    }
-    return 0;
-}
-
-void Othello::flipPieces(int x, int y, Player* player) {
-    for (int i = 0; i < 8; i++) {
-        int count = checkDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], player);
-        if (count > 0) {
-            flipInDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], player, count);
-        }
-    }
-}
-
-void Othello::flipInDirection(int x, int y, int dx, int dy, Player* player, int count) {
-    int nx = x + dx;
-    int ny = y + dy;
-
-    for (int i = 0; i < count; i++) {
-        ChessSquare* square = _grid->getSquare(nx, ny);
-        if (square && square->bit()) {
-            square->destroyBit();
-            Bit* newPiece = createPiece(player);
-            newPiece->setPosition(square->getPosition());
-            square->setBit(newPiece);
-        }
-        nx += dx;
-        ny += dy;
-    }
-}
-
-bool Othello::hasValidMove(Player* player) const {
-    bool hasMove = false;
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        if (!hasMove && isValidMove(x, y, player)) {
-            hasMove = true;
-        }
-    });
-    return hasMove;
-}
-
-std::vector<std::pair<int, int>> Othello::getValidMoves(Player* player) const {
-    std::vector<std::pair<int, int>> moves;
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        if (isValidMove(x, y, player)) {
-            moves.push_back({x, y});
-        }
-    });
-    return moves;
-}
-
 Player* Othello::checkForWinner() {
     // Game ends when neither player can move
-    if (_consecutivePasses >= 2 ||
-        (!hasValidMove(getPlayerAt(BLACK_PLAYER)) && !hasValidMove(getPlayerAt(WHITE_PLAYER)))) {
-
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-
-        if (blackCount > whiteCount) return getPlayerAt(BLACK_PLAYER);
-        if (whiteCount > blackCount) return getPlayerAt(WHITE_PLAYER);
-    }
-
-    // Check if board is full
-    bool boardFull = true;
-    _grid->forEachSquare([&boardFull](ChessSquare* square, int x, int y) {
-        if (!square->bit()) boardFull = false;
-    });
-
-    if (boardFull) {
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-        if (blackCount > whiteCount) return getPlayerAt(BLACK_PLAYER);
-        if (whiteCount > blackCount) return getPlayerAt(WHITE_PLAYER);
-    }
-
-    return nullptr;
+    int winner = _position.winner();
+    return winner < 0 ? nullptr : getPlayerAt(winner);
 }
 
 bool Othello::checkForDraw() {
-    if (_consecutivePasses >= 2 ||
-        (!hasValidMove(getPlayerAt(BLACK_PLAYER)) && !hasValidMove(getPlayerAt(WHITE_PLAYER)))) {
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-        return blackCount == whiteCount;
-    }
-
-    bool boardFull = true;
-    _grid->forEachSquare([&boardFull](ChessSquare* square, int x, int y) {
-        if (!square->bit()) boardFull = false;
-    });
-
-    if (boardFull) {
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-        return blackCount == whiteCount;
-    }
-    return false;
-}
-
-void Othello::countPieces(int &blackCount, int &whiteCount) const {
-    blackCount = 0;
-    whiteCount = 0;
-
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        Bit* piece = square->bit();
-        if (piece) {
-            if (piece->getOwner() == getPlayerAt(BLACK_PLAYER)) {
-                blackCount++;
-            } else {
-                whiteCount++;
-            }
-        }
-    });
+    return _position.gameOver() && _position.winner() < 0;
 }
 
 void Othello::stopGame() {
+    _ponder.stop();
+    _analysis.stop();
+    _slicedSearcher.cancel();
     _grid->forEachSquare([](ChessSquare* square, int x, int y) {
         square->destroyBit();
     });
-    _consecutivePasses = 0;
+    _bitPool.reset();
+    _position.reset();
 }
 
 std::string Othello::initialStateString() {
-    std::string state(64, '0');
-    state[3 * 8 + 3] = '2';  // White at (3,3)
-    state[4 * 8 + 4] = '2';  // White at (4,4)
-    state[4 * 8 + 3] = '1';  // Black at (4,3)
-    state[3 * 8 + 4] = '1';  // Black at (3,4)
-    return state;
+    return OthelloPosition().stateString();
 }
 
 std::string Othello::stateString() {
-    std::string state;
-    _grid->forEachSquare([&state, this](ChessSquare* square, int x, int y) {
-        Bit* bit = square->bit();
-        if (!bit) {
-            state += '0';
-        } else if (bit->getOwner() == getPlayerAt(BLACK_PLAYER)) {
-            state += '1';
-        } else {
-            state += '2';
-        }
-    });
-    return state;
+    return _position.stateString();
 }
 
 void Othello::setStateString(const std::string &s) {
-    if (s.length() != 64) return;
+    _ponder.stop();
+    _slicedSearcher.cancel();
+    if (!_position.setStateString(s)) return;
 
-    int index = 0;
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        if (index < s.length()) {
-            char pieceType = s[index++];
-            square->destroyBit();
-
-            if (pieceType == '1') {
-                Bit* piece = createPiece(getPlayerAt(BLACK_PLAYER));
-                piece->setPosition(square->getPosition());
-                square->setBit(piece);
-            } else if (pieceType == '2') {
-                Bit* piece = createPiece(getPlayerAt(WHITE_PLAYER));
-                piece->setPosition(square->getPosition());
-                square->setBit(piece);
-            }
-        }
-    });
+    // whose turn it is can't be told from the board after a pass, so follow the game
+    _position.setSideToMove(getCurrentPlayer()->playerNumber());
+    syncPieces();
+    restartRecord(_position.sideToMove());
 }
 
-void Othello::updateAI() {
-    if (!gameHasAI()) return;
-
-    Player* aiPlayer = getCurrentPlayer();
-    std::vector<std::pair<int, int>> validMoves = getValidMoves(aiPlayer);
-
-    if (validMoves.empty()) {
-        _consecutivePasses++;
-        endTurn();
+void Othello::drawFrame() {
+    Game::drawFrame();
+    if (!gameCanAnalyse() || !_gameOptions.AIAnalysis) {
+        _analysis.stop();
         return;
     }
+    // a new position to score whenever the board or the side to move changes, a pass only changes the side
+    _analysis.update(stateString() + (char)('0' + _position.sideToMove()), _position, kAnalysisDepth);
+    _drawnAnalysis = _analysis.version();
+    std::vector<Analysis<OthelloPosition>::Line> lines = _analysis.lines();
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (lines[i].move == OthelloPosition::PASS) continue;
+        ChessSquare* square = _grid->getSquare(lines[i].move % 8, lines[i].move / 8);
+        drawScoreLabel(square->getPosition(), Analysis<OthelloPosition>::scoreLabel(lines[i].score), i == 0);
+    }
+}
 
-    // Find move that flips the most pieces
-    int bestX = -1, bestY = -1, maxFlips = 0;
-
-    for (const auto& move : validMoves) {
-        int x = move.first, y = move.second, totalFlips = 0;
-        for (int i = 0; i < 8; i++) {
-            totalFlips += checkDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], aiPlayer);
-        }
-        if (totalFlips > maxFlips) {
-            maxFlips = totalFlips;
-            bestX = x;
-            bestY = y;
+void Othello::updateAI() {
+    if (!gameHasAI() || _position.gameOver()) return;
+    // the ponder search shares the searcher, it has to be finished before anything else touches it
+    _ponder.stop();
+
+    SearchResult<OthelloPosition> result;
+    if (_gameOptions.AISliceMicroseconds > 0) {
+        if (!_slicedSearcher.running()) {
+            SearchLimits limits;
+            limits.depth = getAIMAXDepth();
+            limits.movetime = getAIMoveTime();
+            _slicedSearcher.start(_position, limits);
         }
+        // not done yet, the search waits where it stopped until next frame
+        if (!_slicedSearcher.resume(_gameOptions.AISliceMicroseconds)) return;
+        result = _slicedSearcher.result();
+        _aiStats = _slicedSearcher.stats();
+    } else if (_ponderHash == _position.hash() && _ponderResult.found && _ponderResult.depth >= getAIMAXDepth()) {
+        // the human played the reply we expected and pondering already searched it deep enough
+        result = _ponderResult;
+        _aiStats = _searcher.stats();
+    } else {
+        _slicedSearcher.cancel();
+        // search a copy so the board we draw from is never mid-search
+        OthelloPosition position = _position;
+        SearchLimits limits;
+        limits.depth = getAIMAXDepth();
+        result = _searcher.search(position, limits);
+        _aiStats = _searcher.stats();
     }
+    if (!result.found) return;
+    OthelloPosition::Move move = result.bestMove;
 
-    if (bestX >= 0 && bestY >= 0) {
-        actionForEmptyHolder(*_grid->getSquare(bestX, bestY));
+    if (move == OthelloPosition::PASS) {
+        recordMove(moveCode(move), _position.moveToString(move));
+        _position.play(OthelloPosition::PASS);
+        endTurn();
+    } else {
+        actionForEmptyHolder(*_grid->getSquare(move % 8, move / 8));
     }
-}
-
-void Othello::getBoardPosition(BitHolder& holder, int &x, int &y) const {
-    ChessSquare* square = static_cast<ChessSquare*>(&holder);
-    x = square->getColumn();
-    y = square->getRow();
+    startPondering(result.pv);
+}
+
+//
+// ponders the position after the reply the AI's line expects, searching as deep as it gets
+// with no reply to expect it searches for the human, which still fills the table for every reply
+//
+void Othello::startPondering(const std::vector<int> &pv) {
+    _ponderHash = 0;
+    _ponderResult = SearchResult<OthelloPosition>();
+    if (!gameCanPonder() || !_gameOptions.AIPonder || _gameOptions.AIvsAI || _position.gameOver() || getCurrentPlayer()->isAIPlayer()) return;
+
+    OthelloPosition position = _position;
+    bool predicted = pv.size() >= 2 && position.canPlay(pv[1]);
+    if (predicted) {
+        position.play(pv[1]);
+        _ponderHash = position.hash();
+    }
+    _ponder.start([this, position, predicted](const std::atomic<bool> &stop) mutable {
+        SearchLimits limits;
+        limits.stop = &stop;
+        SearchResult<OthelloPosition> result = _searcher.search(position, limits);
+        if (predicted) {
+            _ponderResult = result;
+        }
+    });
 }
 
 void Othello::showValidMoves(Player* player) {
@@ -339,4 +241,4 @@ void Othello::showValidMoves(Player* player) {
 
 void Othello::clearValidMoveIndicators() {
     _showingHints = false;
-}
\ No newline at end of file
+}
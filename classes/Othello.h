@@ -1,10 +1,15 @@
 #pragma once
 #include "Game.h"
+#include "../core/Analysis.h"
+#include "../core/OthelloPosition.h"
+#include "../core/Ponder.h"
+#include "../core/Search.h"
+#include "../core/SlicedSearch.h"
 #include <vector>
 
-// NOTE: This implementation assumes black.png and white.png exist in resources.
-// If not, you can use o.png and x.png, or any other suitable graphics.
-
+//
+// othello, the rules and AI live in OthelloPosition, this class keeps the discs in step with it
+//
 class Othello : public Game
 {
 public:
@@ -22,39 +27,59 @@ public:
     bool        canBitMoveFrom(Bit &bit, BitHolder &src) override;
     bool        canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
     void        stopGame() override;
+    // draws the analysis scores over the legal squares on top of the board
+    void        drawFrame() override;
 
     // AI methods
     void        updateAI() override;
     bool        gameHasAI() override { return true; } // Set to true when AI is implemented
+    // pondering needs a thread, a time sliced AI is for builds that can't have one
+    bool        gameCanPonder() override { return _gameOptions.AISliceMicroseconds == 0; }
+    bool        gameCanTimeSlice() override { return true; }
+    bool        gameCanAnalyse() override { return _gameOptions.AISliceMicroseconds == 0; }
+    bool        needsFrames() override { return _gameOptions.AIAnalysis && (_analysis.searching() || _analysis.version() != _drawnAnalysis); }
     Grid* getGrid() override { return _grid; }
+    const SearchStats *searchStats() override { return &_aiStats; }
+    int         gameRecordTitle() override { return RECORD_OTHELLO; }
 
 private:
     // Player constants
     static const int BLACK_PLAYER = 0;
     static const int WHITE_PLAYER = 1;
 
-    // Direction vectors for checking all 8 directions
-    static const int DIRECTIONS[8][2];
-
     // Helper methods
     Bit*        createPiece(Player* player);
-    bool        isValidMove(int x, int y, Player* player) const;
-    int         checkDirection(int x, int y, int dx, int dy, Player* player) const;
-    void        flipPieces(int x, int y, Player* player);
-    void        flipInDirection(int x, int y, int dx, int dy, Player* player, int count);
-    bool        hasValidMove(Player* player) const;
-    void        countPieces(int &blackCount, int &whiteCount) const;
-    std::vector<std::pair<int, int>> getValidMoves(Player* player) const;
+    // add, remove and recolor discs until the board matches the position
+    void        syncPieces();
     void        showValidMoves(Player* player);
     void        clearValidMoveIndicators();
-
-    // Board position helper
-    void        getBoardPosition(BitHolder& holder, int &x, int &y) const;
+    // keep searching on the human's turn, pv is the line the AI's move came from
+    void        startPondering(const std::vector<int> &pv);
 
     // Board representation
     Grid*       _grid;
+    OthelloPosition _position;
+    // kept between moves so its transposition table carries over
+    Searcher<OthelloPosition> _searcher;
+    // the same search spread over frames when AISliceMicroseconds is set
+    SlicedSearcher<OthelloPosition> _slicedSearcher;
+    // the AI's last search, copied so the settings window never reads stats a ponder search is writing
+    SearchStats _aiStats;
+    // the position after the reply the AI expects, 0 when pondering every reply, and what the search found there
+    uint64_t    _ponderHash;
+    SearchResult<OthelloPosition> _ponderResult;
 
     // Game state
-    int         _consecutivePasses;
     bool        _showingHints;
-};
\ No newline at end of file
+
+    // disc looks for each player, loaded once so flips are just a recolor
+    TextureRegion _pieceRegions[2];
+    bool        _pieceRegionsLoaded;
+
+    // every legal square's score for the position on the board, and the version of it last drawn
+    Analysis<OthelloPosition> _analysis;
+    uint64_t    _drawnAnalysis;
+
+    // declared last so it stops before the searcher it uses goes away
+    Ponder      _ponder;
+};
@@ -0,0 +1,145 @@
+#include "Profiler.h"
+#include "../imgui/imgui.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+
+static const char *kPhaseNames[] = { "scanForMouse", "updateAI", "drawFrame", "stateString", "ImGui::Render" };
+static_assert(sizeof(kPhaseNames) / sizeof(kPhaseNames[0]) == (int)ProfilePhase::Count, "a name for every phase");
+
+FrameProfiler &FrameProfiler::shared()
+{
+    static FrameProfiler profiler;
+    return profiler;
+}
+
+const char *FrameProfiler::phaseName(ProfilePhase phase)
+{
+    return kPhaseNames[(int)phase];
+}
+
+FrameProfiler::FrameProfiler() : _enabled(false), _inFrame(false), _traced(false), _current(), _frames(), _next(0), _count(0)
+{
+}
+
+void FrameProfiler::setEnabled(bool enabled)
+{
+    // history from before it was hidden would make the graph lie about the gap
+    if (enabled && !_enabled) {
+        _next = 0;
+        _count = 0;
+    }
+    _enabled = enabled;
+}
+
+void FrameProfiler::beginFrame()
+{
+    _traced = Tracer::shared().isEnabled();
+    if (_traced) {
+        Tracer::shared().begin("frame", "frame");
+    }
+    _inFrame = _enabled;
+    if (!_inFrame) {
+        return;
+    }
+    _current = Frame();
+    _frameStart = std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::endFrame()
+{
+    if (_traced) {
+        Tracer::shared().end("frame", "frame");
+        _traced = false;
+    }
+    if (!_inFrame) {
+        return;
+    }
+    _inFrame = false;
+    std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - _frameStart;
+    _current.total = elapsed.count();
+    _frames[_next] = _current;
+    _next = (_next + 1) % HISTORY;
+    _count = std::min(_count + 1, HISTORY);
+}
+
+void FrameProfiler::addTime(ProfilePhase phase, float milliseconds)
+{
+    if (_inFrame) {
+        _current.phases[(int)phase] += milliseconds;
+    }
+}
+
+//
+// min, average and 99th percentile of the frames in the ring
+//
+static void summarize(float *samples, int count, float &minimum, float &average, float &p99)
+{
+    float total = 0.0f;
+    for (int i = 0; i < count; i++) {
+        total += samples[i];
+    }
+    std::sort(samples, samples + count);
+    minimum = samples[0];
+    average = total / count;
+    p99 = samples[std::max(0, (count * 99 + 99) / 100 - 1)];
+}
+
+void FrameProfiler::drawOverlay()
+{
+    if (!_enabled) {
+        return;
+    }
+    ImGui::SetNextWindowBgAlpha(0.85f);
+    bool open = true;
+    if (!ImGui::Begin("Profiler", &open, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing)) {
+        ImGui::End();
+        setEnabled(open);
+        return;
+    }
+    if (_count == 0) {
+        ImGui::Text("Waiting for frames");
+        ImGui::End();
+        setEnabled(open);
+        return;
+    }
+
+    // oldest first so the graph scrolls left
+    float samples[HISTORY];
+    int oldest = (_next - _count + HISTORY) % HISTORY;
+    for (int i = 0; i < _count; i++) {
+        samples[i] = _frames[(oldest + i) % HISTORY].total;
+    }
+    float minimum, average, p99;
+    char overlay[64];
+    snprintf(overlay, sizeof(overlay), "last %.2f ms", samples[_count - 1]);
+    ImGui::PlotLines("##frames", samples, _count, 0, overlay, 0.0f, FLT_MAX, ImVec2(320, 80));
+
+    if (ImGui::BeginTable("Phases", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("ms");
+        ImGui::TableSetupColumn("min");
+        ImGui::TableSetupColumn("avg");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableHeadersRow();
+        for (int phase = -1; phase < PHASES; phase++) {
+            for (int i = 0; i < _count; i++) {
+                const Frame &frame = _frames[(oldest + i) % HISTORY];
+                samples[i] = phase < 0 ? frame.total : frame.phases[phase];
+            }
+            summarize(samples, _count, minimum, average, p99);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", phase < 0 ? "frame" : kPhaseNames[phase]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", minimum);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", average);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", p99);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::Text("%d frames", _count);
+    ImGui::End();
+    setEnabled(open);
+}
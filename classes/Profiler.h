@@ -0,0 +1,100 @@
+#pragma once
+#include "../core/Trace.h"
+#include <chrono>
+
+//
+// the parts of a frame we time
+//
+enum class ProfilePhase
+{
+    ScanForMouse,
+    UpdateAI,
+    DrawFrame,
+    StateString,
+    Render,
+    Count
+};
+
+//
+// per frame timings kept in a ring buffer and shown in an overlay window
+// while hidden nothing is timed, a scope just checks a bool
+// frames and phases also go to the Tracer while it's recording
+//
+class FrameProfiler
+{
+public:
+    static const int HISTORY = 240;
+
+    static FrameProfiler &shared();
+    static const char *phaseName(ProfilePhase phase);
+
+    bool    isEnabled() const { return _enabled; }
+    void    setEnabled(bool enabled);
+
+    // bracket the work of one frame, not the time spent waiting for input or vsync
+    void    beginFrame();
+    void    endFrame();
+    void    addTime(ProfilePhase phase, float milliseconds);
+
+    // the overlay, the only place the history gets summarized
+    void    drawOverlay();
+
+private:
+    FrameProfiler();
+
+    static const int PHASES = (int)ProfilePhase::Count;
+
+    struct Frame
+    {
+        float   total;
+        float   phases[PHASES];
+    };
+
+    bool    _enabled;
+    bool    _inFrame;
+    bool    _traced;
+    std::chrono::steady_clock::time_point _frameStart;
+    Frame   _current;
+    Frame   _frames[HISTORY];
+    int     _next;
+    int     _count;
+};
+
+//
+// times from construction to the end of the enclosing block, or to stop()
+//
+class ProfileScope
+{
+public:
+    ProfileScope(ProfilePhase phase) : _phase(phase), _active(FrameProfiler::shared().isEnabled()), _traced(Tracer::shared().isEnabled())
+    {
+        if (_active) {
+            _start = std::chrono::steady_clock::now();
+        }
+        if (_traced) {
+            Tracer::shared().begin(FrameProfiler::phaseName(phase), "frame");
+        }
+    }
+
+    ~ProfileScope() { stop(); }
+
+    // end the timing before the block does
+    void stop()
+    {
+        if (_active) {
+            std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - _start;
+            FrameProfiler::shared().addTime(_phase, elapsed.count());
+            _active = false;
+        }
+        if (_traced) {
+            Tracer::shared().end(FrameProfiler::phaseName(_phase), "frame");
+            _traced = false;
+        }
+    }
+
+private:
+    ProfilePhase    _phase;
+    bool            _active;
+    bool            _traced;
+    std::chrono::steady_clock::time_point _start;
+};
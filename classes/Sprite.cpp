@@ -1,12 +1,21 @@
 #include "Sprite.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#include "../core/Trace.h"
 #include <iostream>
 #include <filesystem>
 
 // Simple helper function to load an image into a OpenGL texture with common settings
 bool Sprite::LoadTextureFromFile(const char* filename)
 {
+    TraceScope scope("loadTexture", "texture");
+    // images packed into the atlas at startup just point at their region
+    TextureRegion region;
+    if (TextureAtlas::shared().findRegion(filename, region)) {
+        setTextureRegion(region);
+        return true;
+    }
+
     // Load from file
     int image_width = 0;
     int image_height = 0;
@@ -25,6 +34,8 @@ bool Sprite::LoadTextureFromFile(const char* filename)
         return false;
     }
     _size = ImVec2((float)image_width, (float)image_height);
+    _uv0 = ImVec2(0, 0);
+    _uv1 = ImVec2(1, 1);
     return true;
 }
 
@@ -40,7 +51,7 @@ bool Sprite::highlighted()
 	return _highlighted;
 }
 
-#ifdef __APPLE__
+#if defined(__APPLE__) || defined(__linux__)
 #include "../imgui/imgui_impl_opengl3_loader.h"
 
 ImTextureID Sprite::_loadTextureFromMemory(const unsigned char *image_data, int image_width, int image_height)
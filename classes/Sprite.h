@@ -1,6 +1,8 @@
 #pragma once
 #include "Entity.h"
+#include "TextureAtlas.h"
 #include "../imgui/imgui.h"
+#include <cstdint>
 
 class Sprite : public Entity
 {
@@ -16,11 +18,14 @@ public:
         _scale(1),
         _color(1, 1, 1, 1),
         _localZOrder(0),
+        _texture(0),
+        _uv0(0, 0),
+        _uv1(1, 1),
         _highlighted(false)
         { 
             _entityType = EntitySprite;
         };
-    ~Sprite() { if (_retainCount > 0) release(); }
+    ~Sprite() {}
     
     // set the texture to use for this sprite
     void setPosition(float x, float y)
@@ -57,6 +62,24 @@ public:
     int getLocalZOrder() { return _localZOrder; }
     // get rotation
     float getRotation() { return _rotation; }
+    // point the sprite at a region of a shared texture
+    void setTextureRegion(const TextureRegion &region)
+    {
+        _texture = region.texture;
+        _uv0 = region.uv0;
+        _uv1 = region.uv1;
+        _size = region.size;
+    }
+    // the region this sprite currently draws, handy for caching a loaded look
+    TextureRegion getTextureRegion() const
+    {
+        TextureRegion region;
+        region.texture = _texture;
+        region.uv0 = _uv0;
+        region.uv1 = _uv1;
+        region.size = _size;
+        return region;
+    }
     // moveTo
     void moveTo(const ImVec2 &point) { _location = point; }
     // draw the sprite
@@ -66,7 +89,7 @@ public:
         {
             ImGui::SetCursorPos(_location);
             ImVec4 highlight = _highlighted ? ImVec4(1, 1, 0, 1) : ImVec4(0, 0, 0, 0);
-            ImGui::Image((void*)(intptr_t)_texture, _size, ImVec2(0, 0), ImVec2(1, 1), _color, highlight);
+            ImGui::Image((void*)(intptr_t)_texture, _size, _uv0, _uv1, _color, highlight);
         }
     }
 	// is the mouse over this position?
@@ -102,8 +125,12 @@ protected:
     int _localZOrder;
     // the texture we're going to draw
     ImTextureID _texture;
+    // the part of the texture we draw, the whole thing unless it lives in the atlas
+    ImVec2  _uv0;
+    ImVec2  _uv1;
     // currently highlighted
    	bool	_highlighted;
-    // private platform specific texture loading
-    ImTextureID _loadTextureFromMemory(const unsigned char *image_data, int image_width, int image_height);
+    // private platform specific texture loading, shared with the atlas builder
+    friend class TextureAtlas;
+    static ImTextureID _loadTextureFromMemory(const unsigned char *image_data, int image_width, int image_height);
 };
@@ -0,0 +1,135 @@
+#include "TextureAtlas.h"
+#include "Sprite.h"
+#include "stb_image.h"
+// the packer's one implementation outside imgui, imgui_draw.cpp keeps its own copy static
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "../imgui/imstb_rectpack.h"
+#include "../core/Trace.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+// border around each image, filled with its edge pixels so linear filtering never samples a neighbour
+static const int kAtlasPadding = 2;
+static const int kAtlasMinSize = 256;
+static const int kAtlasMaxSize = 4096;
+
+TextureAtlas &TextureAtlas::shared()
+{
+    static TextureAtlas atlas;
+    return atlas;
+}
+
+bool TextureAtlas::build(const char *directory)
+{
+    TraceScope scope("buildAtlas", "texture");
+    struct Image
+    {
+        std::string     name;
+        unsigned char*  pixels;
+        int             width;
+        int             height;
+    };
+    std::vector<Image> images;
+
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator(directory, error)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".png") {
+            continue;
+        }
+        Image image;
+        image.name = entry.path().filename().string();
+        image.pixels = stbi_load(entry.path().string().c_str(), &image.width, &image.height, NULL, 4);
+        if (image.pixels == NULL) {
+            std::cout << "Failed to load texture: " << entry.path().string() << std::endl;
+            continue;
+        }
+        images.push_back(image);
+    }
+    if (images.empty()) {
+        return false;
+    }
+
+    //
+    // find the smallest square power of two that everything fits in
+    //
+    std::vector<stbrp_rect> rects(images.size());
+    int size = kAtlasMinSize;
+    bool packed = false;
+    while (!packed && size <= kAtlasMaxSize) {
+        for (size_t i = 0; i < images.size(); i++) {
+            rects[i].id = (int)i;
+            rects[i].w = images[i].width + kAtlasPadding * 2;
+            rects[i].h = images[i].height + kAtlasPadding * 2;
+            rects[i].was_packed = 0;
+        }
+        std::vector<stbrp_node> nodes(size);
+        stbrp_context context;
+        stbrp_init_target(&context, size, size, nodes.data(), (int)nodes.size());
+        packed = stbrp_pack_rects(&context, rects.data(), (int)rects.size()) != 0;
+        if (!packed) {
+            size *= 2;
+        }
+    }
+    if (!packed) {
+        std::cout << "Texture atlas does not fit in " << kAtlasMaxSize << "x" << kAtlasMaxSize << std::endl;
+        for (Image &image : images) {
+            stbi_image_free(image.pixels);
+        }
+        return false;
+    }
+
+    //
+    // copy every image into place, extruding its edges into the padding
+    //
+    std::vector<unsigned char> pixels((size_t)size * size * 4, 0);
+    std::unordered_map<std::string, TextureRegion> regions;
+    for (const stbrp_rect &rect : rects) {
+        const Image &image = images[rect.id];
+        int originX = rect.x + kAtlasPadding;
+        int originY = rect.y + kAtlasPadding;
+        for (int y = -kAtlasPadding; y < image.height + kAtlasPadding; y++) {
+            int srcY = std::clamp(y, 0, image.height - 1);
+            for (int x = -kAtlasPadding; x < image.width + kAtlasPadding; x++) {
+                int srcX = std::clamp(x, 0, image.width - 1);
+                const unsigned char *src = image.pixels + ((size_t)srcY * image.width + srcX) * 4;
+                unsigned char *dst = pixels.data() + ((size_t)(originY + y) * size + (originX + x)) * 4;
+                memcpy(dst, src, 4);
+            }
+        }
+
+        TextureRegion region;
+        region.uv0 = ImVec2((float)originX / size, (float)originY / size);
+        region.uv1 = ImVec2((float)(originX + image.width) / size, (float)(originY + image.height) / size);
+        region.size = ImVec2((float)image.width, (float)image.height);
+        regions[image.name] = region;
+    }
+    for (Image &image : images) {
+        stbi_image_free(image.pixels);
+    }
+
+    ImTextureID texture = Sprite::_loadTextureFromMemory(pixels.data(), size, size);
+    if (texture == 0) {
+        return false;
+    }
+    for (auto &entry : regions) {
+        entry.second.texture = texture;
+    }
+    _texture = texture;
+    _width = size;
+    _height = size;
+    _regions = std::move(regions);
+    return true;
+}
+
+bool TextureAtlas::findRegion(const std::string &name, TextureRegion &region) const
+{
+    auto it = _regions.find(name);
+    if (it == _regions.end()) {
+        return false;
+    }
+    region = it->second;
+    return true;
+}
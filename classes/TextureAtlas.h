@@ -0,0 +1,44 @@
+#pragma once
+#include "../imgui/imgui.h"
+#include <string>
+#include <unordered_map>
+
+//
+// a rectangle inside a texture, sprites draw with these so they can all share one texture
+//
+struct TextureRegion
+{
+    ImTextureID texture = 0;
+    ImVec2      uv0 = ImVec2(0, 0);
+    ImVec2      uv1 = ImVec2(1, 1);
+    ImVec2      size = ImVec2(0, 0);
+};
+
+//
+// packs every image in the resources folder into a single texture at startup
+// so a whole board goes out in one or two draw calls instead of one per texture switch
+//
+class TextureAtlas
+{
+public:
+    TextureAtlas() : _texture(0), _width(0), _height(0) {}
+
+    // the atlas used by every sprite
+    static TextureAtlas &shared();
+
+    // load and pack all the .png files in directory, needs a live graphics context
+    bool build(const char *directory);
+    // look up a packed image by its file name, e.g. "red.png"
+    bool findRegion(const std::string &name, TextureRegion &region) const;
+
+    bool        isBuilt() const { return _texture != 0; }
+    ImTextureID getTexture() const { return _texture; }
+    int         getWidth() const { return _width; }
+    int         getHeight() const { return _height; }
+
+private:
+    ImTextureID _texture;
+    int         _width;
+    int         _height;
+    std::unordered_map<std::string, TextureRegion> _regions;
+};
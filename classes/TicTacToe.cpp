@@ -17,10 +17,10 @@ TicTacToe::~TicTacToe()
 Bit* TicTacToe::PieceForPlayer(const int playerNumber)
 {
     // depending on playerNumber load the "x.png" or the "o.png" graphic
-    Bit *bit = new Bit();
+    Bit *bit = _bitPool.allocate();
     // should possibly be cached from player class?
-    bit->LoadTextureFromFile(playerNumber == AI_PLAYER ? "o.png" : "x.png");
-    bit->setOwner(getPlayerAt(playerNumber == AI_PLAYER ? 1 : 0));
+    bit->LoadTextureFromFile(playerNumber == 1 ? "o.png" : "x.png");
+    bit->setOwner(getPlayerAt(playerNumber));
     return bit;
 }
 
@@ -29,7 +29,10 @@ void TicTacToe::setUpBoard()
     setNumberOfPlayers(2);
     _gameOptions.rowX = 3;
     _gameOptions.rowY = 3;
+    // the whole game tree is only nine plies deep
+    _gameOptions.AIMAXDepth = 9;
     _grid->initializeSquares(80, "square.png");
+    _position.reset();
 
     if (gameHasAI()) {
         setAIPlayer(AI_PLAYER);
@@ -46,8 +49,15 @@ bool TicTacToe::actionForEmptyHolder(BitHolder &holder)
     if (holder.bit()) {
         return false;
     }
-    Bit *bit = PieceForPlayer(getCurrentPlayer()->playerNumber() == 0 ? HUMAN_PLAYER : AI_PLAYER);
+    ChessSquare *square = static_cast<ChessSquare*>(&holder);
+    int index = square->getRow() * 3 + square->getColumn();
+    if (!_position.canPlay(index)) {
+        return false;
+    }
+    Bit *bit = PieceForPlayer(_position.sideToMove());
     if (bit) {
+        recordMove(moveCode(index), _position.moveToString(index));
+        _position.play(index);
         bit->setPosition(holder.getPosition());
         holder.setBit(bit);
         endTurn();
@@ -76,44 +86,19 @@ void TicTacToe::stopGame()
     _grid->forEachSquare([](ChessSquare* square, int x, int y) {
         square->destroyBit();
     });
-}
-
-//
-// helper function for the winner check
-//
-Player* TicTacToe::ownerAt(int index ) const
-{
-    auto square = _grid->getSquare(index % 3, index / 3);
-    if (!square || !square->bit()) {
-        return nullptr;
-    }
-    return square->bit()->getOwner();
+    _bitPool.reset();
+    _position.reset();
 }
 
 Player* TicTacToe::checkForWinner()
 {
-    static const int kWinningTriples[8][3] =  { {0,1,2}, {3,4,5}, {6,7,8},  // rows
-                                                {0,3,6}, {1,4,7}, {2,5,8},  // cols
-                                                {0,4,8}, {2,4,6} };         // diagonals
-    for( int i=0; i<8; i++ ) {
-        const int *triple = kWinningTriples[i];
-        Player *player = ownerAt(triple[0]);
-        if( player && player == ownerAt(triple[1]) && player == ownerAt(triple[2]) )
-            return player;
-    }
-    return nullptr;
+    int winner = _position.winner();
+    return winner < 0 ? nullptr : getPlayerAt(winner);
 }
 
 bool TicTacToe::checkForDraw()
 {
-    bool isDraw = true;
-    // check to see if the board is full
-    _grid->forEachSquare([&isDraw](ChessSquare* square, int x, int y) {
-        if (!square->bit()) {
-            isDraw = false;
-        }
-    });
-    return isDraw;
+    return _position.gameOver() && _position.winner() < 0;
 }
 
 //
@@ -130,14 +115,7 @@ std::string TicTacToe::initialStateString()
 //
 std::string TicTacToe::stateString()
 {
-    std::string s = "000000000";
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        Bit *bit = square->bit();
-        if (bit) {
-            s[y * 3 + x] = std::to_string(bit->getOwner()->playerNumber()+1)[0];
-        }
-    });
-    return s;
+    return _position.stateString();
 }
 
 //
@@ -146,15 +124,20 @@ std::string TicTacToe::stateString()
 //
 void TicTacToe::setStateString(const std::string &s)
 {
+    if (!_position.setStateString(s)) {
+        return;
+    }
     _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        int index = y*3 + x;
-        int playerNumber = s[index] - '0';
-        if (playerNumber) {
-            square->setBit( PieceForPlayer(playerNumber-1) );
+        int playerNumber = _position.pieceAt(y * 3 + x);
+        if (playerNumber >= 0) {
+            Bit *bit = PieceForPlayer(playerNumber);
+            bit->setPosition(square->getPosition());
+            square->setBit(bit);
         } else {
             square->setBit( nullptr );
         }
     });
+    restartRecord(_position.sideToMove());
 }
 
 
@@ -163,85 +146,15 @@ void TicTacToe::setStateString(const std::string &s)
 //
 void TicTacToe::updateAI() 
 {
-    int bestVal = -1000;
-    BitHolder* bestMove = nullptr;
-    std::string state = stateString();
-
-    // Traverse all cells, evaluate minimax function for all empty cells
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        int index = y * 3 + x;
-        // Check if cell is empty
-        if (state[index] == '0') {
-            // Make the move
-            state[index] = '2';
-            int moveVal = -negamax(state, 0, HUMAN_PLAYER);
-            // Undo the move
-            state[index] = '0';
-            // If the value of the current move is more than the best value, update best
-            if (moveVal > bestVal) {
-                bestMove = square;
-                bestVal = moveVal;
-            }
-        }
-    });
-
-
-    // Make the best move
-    if(bestMove) {
-        if (actionForEmptyHolder(*bestMove)) {
-        }
+    if (_position.gameOver()) {
+        return;
     }
-}
-
-bool isAIBoardFull(const std::string& state) {
-    return state.find('0') == std::string::npos;
-}
-
-int evaluateAIBoard(const std::string& state) {
-    static const int kWinningTriples[8][3] =  { {0,1,2}, {3,4,5}, {6,7,8},  // rows
-                                                {0,3,6}, {1,4,7}, {2,5,8},  // cols
-                                                {0,4,8}, {2,4,6} };         // diagonals
-    for( int i=0; i<8; i++ ) {
-        const int *triple = kWinningTriples[i];
-        char first = state[triple[0]];
-        if( first != '0' && first == state[triple[1]] && first == state[triple[2]] ) {
-            return 10;   // someone won, negamax will handle who
-        }
+    // search a copy so the board we draw from is never mid-search
+    TicTacToePosition position = _position;
+    SearchLimits limits;
+    limits.depth = getAIMAXDepth();
+    SearchResult<TicTacToePosition> result = _searcher.search(position, limits);
+    if (result.found) {
+        actionForEmptyHolder(*_grid->getSquare(result.bestMove % 3, result.bestMove / 3));
     }
-    return 0; // No winner
 }
-
-//
-// player is the current player's number (AI or human)
-//
-int TicTacToe::negamax(std::string& state, int depth, int playerColor) 
-{
-    int score = evaluateAIBoard(state);
-
-    // Check if AI wins, human wins, or draw
-    if(score) { 
-        // A winning state is a loss for the player whose turn it is.
-        // The previous player made the winning move.
-        return -score; 
-    }
-
-    if(isAIBoardFull(state)) {
-        return 0; // Draw
-    }
-
-    int bestVal = -1000; // Min value
-    for (int y = 0; y < 3; y++) {
-        for (int x = 0; x < 3; x++) {
-            // Check if cell is empty
-            if (state[y * 3 + x] == '0') {
-                // Make the move
-                state[y * 3 + x] = playerColor == HUMAN_PLAYER ? '1' : '2'; // Set the cell to the current player's color
-                bestVal = std::max(bestVal, -negamax(state, depth + 1, -playerColor));
-                // Undo the move for backtracking
-                state[y * 3 + x] = '0';
-            }
-        }
-    }
-
-    return bestVal;
-}
\ No newline at end of file
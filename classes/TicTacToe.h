@@ -1,5 +1,7 @@
 #pragma once
 #include "Game.h"
+#include "../core/TicTacToePosition.h"
+#include "../core/Search.h"
 
 //
 // the classic game of tic tac toe
@@ -30,11 +32,14 @@ public:
 	void        updateAI() override;
     bool        gameHasAI() override { return true; }
     Grid* getGrid() override { return _grid; }
+    const SearchStats *searchStats() override { return &_searcher.stats(); }
+    int         gameRecordTitle() override { return RECORD_TICTACTOE; }
 private:
     Bit *       PieceForPlayer(const int playerNumber);
-    Player*     ownerAt(int index ) const;
-    int         negamax(std::string& state, int depth, int playerColor);
 
     Grid*       _grid;
+    TicTacToePosition _position;
+    // kept between moves so its transposition table carries over
+    Searcher<TicTacToePosition> _searcher;
 };
 
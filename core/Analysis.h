@@ -0,0 +1,117 @@
+#pragma once
+#include "Ponder.h"
+#include "Search.h"
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//
+// scores every legal move of whatever position the board is showing, as background work on the shared scheduler
+// a new state string starts a fresh multi-pv search, the searcher and its table are kept so
+// positions that come round again, or follow from the last one, are quick to fill in
+// each depth's lines are published as soon as it finishes, the board draws whatever is there
+// when the AI's move preempts it the search starts over, lines only get replaced once it's back past where it was
+//
+template <class Position>
+class Analysis
+{
+public:
+    typedef typename SearchResult<Position>::Line Line;
+
+    Analysis() : _depth(0), _searching(false), _version(0) {}
+
+    // analyse position unless state says it's the one already being looked at
+    void update(const std::string &state, const Position &position, int maxDepth)
+    {
+        if (state == _state) {
+            return;
+        }
+        _thread.stop();
+        // a cancelled search never gets to say it's done, and a game that's over won't start another
+        _searching = false;
+        _state = state;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _lines.clear();
+            _depth = 0;
+        }
+        _version++;
+        if (position.gameOver()) {
+            return;
+        }
+        _searching = true;
+        // a copy of its own, the board's position changes under it
+        Position searched = position;
+        _thread.start([this, searched, maxDepth](const std::atomic<bool> &stop) mutable {
+            SearchLimits limits;
+            limits.depth = maxDepth;
+            limits.multiPv = Position::Moves::CAPACITY;
+            limits.stop = &stop;
+            _searcher.search(searched, limits, [this](const SearchResult<Position> &result) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (result.depth < _depth) {
+                    return;
+                }
+                _lines = result.lines;
+                _depth = result.depth;
+                _version++;
+            });
+            // stopped it's either cancelled, and stop() says so, or preempted and still going once it's run again
+            if (!stop) {
+                _searching = false;
+            }
+        });
+    }
+
+    // look things up in, and leave results in, the game's own search table, the two can run at once
+    void shareTable(TranspositionTable &table) { _searcher.shareTable(table); }
+
+    // stop searching and forget the position, the next update starts again
+    void stop()
+    {
+        _thread.stop();
+        _searching = false;
+        _state.clear();
+    }
+
+    // true until the search reaches its depth
+    bool searching() const { return _searching; }
+    // goes up whenever the lines change, a board that drew an older version needs another frame
+    uint64_t version() const { return _version; }
+
+    // the last finished depth's lines, best first
+    std::vector<Line> lines(int *depth = nullptr) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (depth) {
+            *depth = _depth;
+        }
+        return _lines;
+    }
+
+    // short enough to fit on a square, "+12", "W5" to win in 5 plies or "L4" to lose in 4
+    static std::string scoreLabel(int score)
+    {
+        char text[16];
+        if (isWinScore(score)) {
+            int plies = SEARCH_WIN_SCORE - (score > 0 ? score : -score);
+            snprintf(text, sizeof(text), "%c%d", score > 0 ? 'W' : 'L', plies);
+        } else {
+            snprintf(text, sizeof(text), "%+d", score);
+        }
+        return text;
+    }
+
+private:
+    // declared before the thread so they outlive it
+    Searcher<Position>  _searcher;
+    mutable std::mutex  _mutex;
+    std::vector<Line>   _lines;
+    int                 _depth;
+    std::atomic<bool>   _searching;
+    std::atomic<uint64_t> _version;
+    std::string         _state;
+    Ponder              _thread;
+};
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+//
+// bump allocator, memory is handed out in order from big blocks and only ever given back all at once
+// reset keeps the blocks, so a tree rebuilt every move stops touching malloc after the first
+// only for types with nothing to destroy, nothing here ever runs a destructor
+//
+class Arena
+{
+public:
+    static const size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+
+    Arena(size_t blockSize = DEFAULT_BLOCK_SIZE) : _blockSize(blockSize), _block(0), _offset(0), _used(0) {}
+    ~Arena()
+    {
+        for (char *block : _blocks) {
+            free(block);
+        }
+    }
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t bytes, size_t alignment)
+    {
+        while (true) {
+            if (_block < _blocks.size()) {
+                size_t start = (_offset + alignment - 1) & ~(alignment - 1);
+                if (start + bytes <= _blockSize) {
+                    _offset = start + bytes;
+                    _used += bytes;
+                    return _blocks[_block] + start;
+                }
+                // what's left of this block is wasted until the next reset
+                _block++;
+                _offset = 0;
+                continue;
+            }
+            if (bytes > _blockSize) {
+                return nullptr;
+            }
+            char *block = (char *)malloc(_blockSize);
+            if (!block) {
+                return nullptr;
+            }
+            _blocks.push_back(block);
+        }
+    }
+
+    // count default constructed Ts, nullptr if memory ran out
+    template <class T>
+    T *allocateArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        void *memory = allocate(sizeof(T) * count, alignof(T));
+        if (!memory) {
+            return nullptr;
+        }
+        T *items = (T *)memory;
+        for (size_t i = 0; i < count; i++) {
+            new (&items[i]) T();
+        }
+        return items;
+    }
+
+    void reset()
+    {
+        _block = 0;
+        _offset = 0;
+        _used = 0;
+    }
+
+    // bytes handed out since the last reset, and bytes held from the system
+    size_t used() const { return _used; }
+    size_t reserved() const { return _blocks.size() * _blockSize; }
+
+private:
+    size_t              _blockSize;
+    std::vector<char *> _blocks;
+    size_t              _block;     // block being handed out from
+    size_t              _offset;    // next free byte in it
+    size_t              _used;
+};
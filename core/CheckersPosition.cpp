@@ -0,0 +1,361 @@
+#include "CheckersPosition.h"
+#include "BitOps.h"
+
+//
+// neighbours of every dark square, directions are up-left, up-right, down-left, down-right
+// -1 where the step or jump would leave the board
+//
+struct CheckersTables
+{
+    int step[32][4];
+    int jump[32][4];
+
+    CheckersTables()
+    {
+        const int directions[4][2] = { {-1, -1}, {1, -1}, {-1, 1}, {1, 1} };
+        for (int square = 0; square < 32; square++) {
+            int x, y;
+            CheckersPosition::coordinates(square, x, y);
+            for (int d = 0; d < 4; d++) {
+                int sx = x + directions[d][0], sy = y + directions[d][1];
+                int jx = x + directions[d][0] * 2, jy = y + directions[d][1] * 2;
+                step[square][d] = (sx >= 0 && sx < 8 && sy >= 0 && sy < 8) ? CheckersPosition::squareAt(sx, sy) : -1;
+                jump[square][d] = (jx >= 0 && jx < 8 && jy >= 0 && jy < 8) ? CheckersPosition::squareAt(jx, jy) : -1;
+            }
+        }
+    }
+};
+
+static const CheckersTables kTables;
+
+// red men move down the board, yellow men move up it
+static const int kFirstDirection[2] = { 2, 0 };
+static const uint32_t kCrownRow[2] = { 0xf0000000u, 0x0000000fu };
+static const uint32_t kStartRed = 0x00000fffu;
+static const uint32_t kStartYellow = 0xfff00000u;
+
+static uint32_t squareBit(int square)
+{
+    return 1u << square;
+}
+
+CheckersPosition::CheckersPosition()
+{
+    reset();
+}
+
+void CheckersPosition::reset()
+{
+    _men[0] = kStartRed;
+    _men[1] = kStartYellow;
+    _kings[0] = _kings[1] = 0;
+    _side = 0;
+    _plies = 0;
+    _quietPlies = 0;
+}
+
+int CheckersPosition::squareAt(int x, int y)
+{
+    if (x < 0 || x >= 8 || y < 0 || y >= 8 || (x + y) % 2 != 1) {
+        return -1;
+    }
+    return y * 4 + x / 2;
+}
+
+void CheckersPosition::coordinates(int square, int &x, int &y)
+{
+    y = square / 4;
+    x = (square % 4) * 2 + (y % 2 == 0 ? 1 : 0);
+}
+
+//
+// extend a jump from square in every direction it can go, recording the move once it can't go further
+//
+void CheckersPosition::_addJumps(Moves &list, Move &move, int square, bool king, uint32_t captured) const
+{
+    // a man that reaches the far row is crowned and the move ends there
+    if (!king && move.length > 1 && (kCrownRow[_side] & squareBit(square))) {
+        move.captured = captured;
+        list.push(move);
+        return;
+    }
+    uint32_t theirs = _men[_side ^ 1] | _kings[_side ^ 1];
+    uint32_t occupied = _men[0] | _men[1] | _kings[0] | _kings[1];
+    // the jumping piece has left its starting square
+    occupied &= ~squareBit(move.from());
+
+    bool extended = false;
+    int first = king ? 0 : kFirstDirection[_side];
+    int last = king ? 4 : kFirstDirection[_side] + 2;
+    for (int d = first; d < last; d++) {
+        int over = kTables.step[square][d];
+        int land = kTables.jump[square][d];
+        if (over < 0 || land < 0) {
+            continue;
+        }
+        if (!(theirs & squareBit(over)) || (captured & squareBit(over)) || (occupied & squareBit(land))) {
+            continue;
+        }
+        if (move.length >= CheckersMove::MAX_PATH || list.size() >= 128) {
+            continue;
+        }
+        move.path[move.length++] = (uint8_t)land;
+        _addJumps(list, move, land, king, captured | squareBit(over));
+        move.length--;
+        extended = true;
+    }
+    if (!extended && move.length > 1) {
+        move.captured = captured;
+        list.push(move);
+    }
+}
+
+void CheckersPosition::moves(Moves &list) const
+{
+    list.clear();
+    if (isDraw()) {
+        return;
+    }
+    uint32_t mine = _men[_side] | _kings[_side];
+    uint32_t occupied = _men[0] | _men[1] | _kings[0] | _kings[1];
+
+    // jumps are compulsory, so only look at steps when there are none
+    uint32_t pieces = mine;
+    while (pieces) {
+        int square = lowestBit(pieces);
+        pieces &= pieces - 1;
+        Move move;
+        move.path[0] = (uint8_t)square;
+        move.length = 1;
+        move.captured = 0;
+        _addJumps(list, move, square, (_kings[_side] & squareBit(square)) != 0, 0);
+    }
+    if (!list.empty()) {
+        return;
+    }
+
+    pieces = mine;
+    while (pieces) {
+        int square = lowestBit(pieces);
+        pieces &= pieces - 1;
+        bool king = (_kings[_side] & squareBit(square)) != 0;
+        int first = king ? 0 : kFirstDirection[_side];
+        int last = king ? 4 : kFirstDirection[_side] + 2;
+        for (int d = first; d < last; d++) {
+            int to = kTables.step[square][d];
+            if (to >= 0 && !(occupied & squareBit(to))) {
+                Move move;
+                move.path[0] = (uint8_t)square;
+                move.path[1] = (uint8_t)to;
+                move.length = 2;
+                move.captured = 0;
+                list.push(move);
+            }
+        }
+    }
+}
+
+void CheckersPosition::play(const Move &move)
+{
+    Undo &undo = _undo[_plies % MAX_PLIES];
+    int other = _side ^ 1;
+    uint32_t from = squareBit(move.from());
+    uint32_t to = squareBit(move.to());
+    bool king = (_kings[_side] & from) != 0;
+
+    undo.capturedMen = _men[other] & move.captured;
+    undo.capturedKings = _kings[other] & move.captured;
+    undo.crowned = false;
+    undo.quietPlies = _quietPlies;
+    _men[other] &= ~move.captured;
+    _kings[other] &= ~move.captured;
+
+    if (king) {
+        _kings[_side] ^= from | to;
+    } else {
+        _men[_side] &= ~from;
+        if (kCrownRow[_side] & to) {
+            _kings[_side] |= to;
+            undo.crowned = true;
+        } else {
+            _men[_side] |= to;
+        }
+    }
+    // only king shuffles count towards the draw
+    _quietPlies = (move.captured || !king) ? 0 : _quietPlies + 1;
+    _plies++;
+    _side = other;
+}
+
+void CheckersPosition::undo(const Move &move)
+{
+    _side ^= 1;
+    _plies--;
+    const Undo &undo = _undo[_plies % MAX_PLIES];
+    int other = _side ^ 1;
+    uint32_t from = squareBit(move.from());
+    uint32_t to = squareBit(move.to());
+
+    if (_kings[_side] & to) {
+        _kings[_side] &= ~to;
+        if (undo.crowned) {
+            _men[_side] |= from;
+        } else {
+            _kings[_side] |= from;
+        }
+    } else {
+        _men[_side] ^= from | to;
+    }
+    _men[other] |= undo.capturedMen;
+    _kings[other] |= undo.capturedKings;
+    _quietPlies = undo.quietPlies;
+}
+
+bool CheckersPosition::gameOver() const
+{
+    if (isDraw()) {
+        return true;
+    }
+    Moves list;
+    moves(list);
+    return list.empty();
+}
+
+int CheckersPosition::winner() const
+{
+    if (isDraw()) {
+        return -1;
+    }
+    Moves list;
+    moves(list);
+    return list.empty() ? (_side ^ 1) : -1;
+}
+
+int CheckersPosition::eval() const
+{
+    static const int kManValue = 100;
+    static const int kKingValue = 160;
+    static const int kAdvanceValue = 2;
+    int score = 0;
+    for (int player = 0; player < 2; player++) {
+        int sign = player == _side ? 1 : -1;
+        score += sign * (popCount(_men[player]) * kManValue + popCount(_kings[player]) * kKingValue);
+        uint32_t men = _men[player];
+        while (men) {
+            int row = lowestBit(men) / 4;
+            score += sign * kAdvanceValue * (player == 0 ? row : 7 - row);
+            men &= men - 1;
+        }
+    }
+    return score;
+}
+
+uint64_t CheckersPosition::hash() const
+{
+    uint64_t men = ((uint64_t)_men[1] << 32) | _men[0];
+    uint64_t kings = ((uint64_t)_kings[1] << 32) | _kings[0];
+    return combineHash(mixHash(men) ^ (uint64_t)_side, kings);
+}
+
+int CheckersPosition::pieceAt(int square) const
+{
+    uint32_t bit = squareBit(square);
+    if (_men[0] & bit) return RED_MAN;
+    if (_kings[0] & bit) return RED_KING;
+    if (_men[1] & bit) return YELLOW_MAN;
+    if (_kings[1] & bit) return YELLOW_KING;
+    return EMPTY;
+}
+
+int CheckersPosition::pieceCount(int player) const
+{
+    return popCount(_men[player] | _kings[player]);
+}
+
+std::string CheckersPosition::stateString() const
+{
+    std::string state(32, '0');
+    for (int square = 0; square < 32; square++) {
+        state[square] = (char)('0' + pieceAt(square));
+    }
+    return state;
+}
+
+bool CheckersPosition::setStateString(const std::string &s)
+{
+    if (s.length() != 32) {
+        return false;
+    }
+    uint32_t men[2] = { 0, 0 };
+    uint32_t kings[2] = { 0, 0 };
+    for (int square = 0; square < 32; square++) {
+        switch (s[square]) {
+            case '0': break;
+            case '1': men[0] |= squareBit(square); break;
+            case '2': kings[0] |= squareBit(square); break;
+            case '3': men[1] |= squareBit(square); break;
+            case '4': kings[1] |= squareBit(square); break;
+            default: return false;
+        }
+    }
+    _men[0] = men[0];
+    _men[1] = men[1];
+    _kings[0] = kings[0];
+    _kings[1] = kings[1];
+    _side = 0;
+    _plies = 0;
+    _quietPlies = 0;
+    return true;
+}
+
+static std::string squareName(int square)
+{
+    int x, y;
+    CheckersPosition::coordinates(square, x, y);
+    std::string name;
+    name += (char)('a' + x);
+    name += (char)('1' + (7 - y));
+    return name;
+}
+
+std::string CheckersPosition::moveToString(const Move &move) const
+{
+    std::string text = squareName(move.path[0]);
+    for (int i = 1; i < move.length; i++) {
+        text += move.isCapture() ? 'x' : '-';
+        text += squareName(move.path[i]);
+    }
+    return text;
+}
+
+//
+// accepts the full path with or without separators, or just the start and end squares if that is unambiguous
+//
+bool CheckersPosition::parseMove(const std::string &text, Move &move) const
+{
+    auto squaresOnly = [](const std::string &s) {
+        std::string out;
+        for (char c : s) {
+            if (c != '-' && c != 'x') {
+                out += c;
+            }
+        }
+        return out;
+    };
+    std::string wanted = squaresOnly(text);
+    Moves list;
+    moves(list);
+    int matches = 0;
+    for (const Move &candidate : list) {
+        std::string full = squaresOnly(moveToString(candidate));
+        if (full == wanted) {
+            move = candidate;
+            return true;
+        }
+        if (wanted.length() == 4 && wanted == squareName(candidate.from()) + squareName(candidate.to())) {
+            move = candidate;
+            matches++;
+        }
+    }
+    return matches == 1;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include "MoveList.h"
+#include <cstdint>
+#include <string>
+
+//
+// a checkers move, the squares the piece lands on in order and everything it jumps
+//
+struct CheckersMove
+{
+    static const int MAX_PATH = 13;
+
+    uint8_t     path[MAX_PATH];     // path[0] is where the piece starts
+    uint8_t     length;             // squares in path, 2 for a simple move
+    uint32_t    captured;           // squares jumped over
+
+    int         from() const { return path[0]; }
+    int         to() const { return path[length - 1]; }
+    bool        isCapture() const { return captured != 0; }
+    bool operator==(const CheckersMove &other) const
+    {
+        if (length != other.length || captured != other.captured) {
+            return false;
+        }
+        for (int i = 0; i < length; i++) {
+            if (path[i] != other.path[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// what a transposition table keeps, start and end squares and a few bits of the jumped squares to tell
+// apart jumps that start and end in the same place
+inline uint16_t moveCode(const CheckersMove &move)
+{
+    return (uint16_t)(move.from() | move.to() << 5 | (((uint64_t)move.captured * 0x9e3779b97f4a7c15ULL) >> 58) << 10);
+}
+
+//
+// english draughts rules on 32 bit boards, no rendering
+// only the dark squares are used, square = y * 4 + x / 2 with y = 0 the top row
+// player 0 (red) starts at the top and moves first, player 1 (yellow) starts at the bottom
+// jumps are compulsory and must be completed, reaching the far row crowns a man and ends the move
+//
+class CheckersPosition
+{
+public:
+    // undo history is a ring, nothing needs to take back more plies than this
+    static const int MAX_PLIES = 512;
+    // plies without a capture or a man moving before the game is drawn
+    static const int DRAW_PLIES = 80;
+
+    // piece codes used by state strings, same as the game window's gameTags
+    static const int EMPTY = 0;
+    static const int RED_MAN = 1;
+    static const int RED_KING = 2;
+    static const int YELLOW_MAN = 3;
+    static const int YELLOW_KING = 4;
+
+    typedef CheckersMove Move;
+    typedef MoveList<Move, 128> Moves;
+
+    CheckersPosition();
+
+    void        reset();
+
+    void        moves(Moves &list) const;
+    void        play(const Move &move);
+    void        undo(const Move &move);
+
+    int         sideToMove() const { return _side; }
+    void        setSideToMove(int side) { _side = side; }
+    int         plies() const { return _plies; }
+    bool        gameOver() const;
+    bool        isDraw() const { return _quietPlies >= DRAW_PLIES; }
+    // the side that can't move loses, -1 while playing or on a draw
+    int         winner() const;
+    // material and advancement from the side to move's point of view
+    int         eval() const;
+    uint64_t    hash() const;
+
+    // one of the piece codes above
+    int         pieceAt(int square) const;
+    int         pieceCount(int player) const;
+
+    // dark square for board coordinates, -1 for a light square
+    static int  squareAt(int x, int y);
+    static void coordinates(int square, int &x, int &y);
+
+    // a digit per dark square, top row first, the side to move is assumed to be red
+    std::string stateString() const;
+    bool        setStateString(const std::string &s);
+
+    // squares are written a1 to h8 with a1 bottom left, "c3-d4" for a step, "c3xe5xg3" for jumps
+    std::string moveToString(const Move &move) const;
+    bool        parseMove(const std::string &text, Move &move) const;
+
+private:
+    struct Undo
+    {
+        uint32_t    capturedMen;
+        uint32_t    capturedKings;
+        bool        crowned;
+        int         quietPlies;
+    };
+
+    void        _addJumps(Moves &list, Move &move, int square, bool king, uint32_t captured) const;
+
+    uint32_t    _men[2];
+    uint32_t    _kings[2];
+    int         _side;
+    int         _plies;
+    int         _quietPlies;
+    Undo        _undo[MAX_PLIES];
+};
@@ -0,0 +1,978 @@
+#include "ChessPosition.h"
+#include "BitOps.h"
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+static uint64_t squareBit(int square)
+{
+    return 1ULL << square;
+}
+
+//
+// PeSTO's piece-square tables, middle and end game, each laid out a8 first the way white looks at the board
+// the piece values are folded in when the tables are built
+//
+static const int kMiddleGameValue[7] = { 0, 82, 337, 365, 477, 1025, 0 };
+static const int kEndGameValue[7] = { 0, 94, 281, 297, 512, 936, 0 };
+// how much each piece counts toward the middle game, 24 with everything on the board
+static const int kPhaseWeight[7] = { 0, 0, 1, 1, 2, 4, 0 };
+
+static const int kMiddleGameTables[7][64] = {
+    {},
+    {
+          0,   0,   0,   0,   0,   0,   0,   0,
+         98, 134,  61,  95,  68, 126,  34, -11,
+         -6,   7,  26,  31,  65,  56,  25, -20,
+        -14,  13,   6,  21,  23,  12,  17, -23,
+        -27,  -2,  -5,  12,  17,   6,  10, -25,
+        -26,  -4,  -4, -10,   3,   3,  33, -12,
+        -35,  -1, -20, -23, -15,  24,  38, -22,
+          0,   0,   0,   0,   0,   0,   0,   0,
+    },
+    {
+       -167, -89, -34, -49,  61, -97, -15,-107,
+        -73, -41,  72,  36,  23,  62,   7, -17,
+        -47,  60,  37,  65,  84, 129,  73,  44,
+         -9,  17,  19,  53,  37,  69,  18,  22,
+        -13,   4,  16,  13,  28,  19,  21,  -8,
+        -23,  -9,  12,  10,  19,  17,  25, -16,
+        -29, -53, -12,  -3,  -1,  18, -14, -19,
+       -105, -21, -58, -33, -17, -28, -19, -23,
+    },
+    {
+        -29,   4, -82, -37, -25, -42,   7,  -8,
+        -26,  16, -18, -13,  30,  59,  18, -47,
+        -16,  37,  43,  40,  35,  50,  37,  -2,
+         -4,   5,  19,  50,  37,  37,   7,  -2,
+         -6,  13,  13,  26,  34,  12,  10,   4,
+          0,  15,  15,  15,  14,  27,  18,  10,
+          4,  15,  16,   0,   7,  21,  33,   1,
+        -33,  -3, -14, -21, -13, -12, -39, -21,
+    },
+    {
+         32,  42,  32,  51,  63,   9,  31,  43,
+         27,  32,  58,  62,  80,  67,  26,  44,
+         -5,  19,  26,  36,  17,  45,  61,  16,
+        -24, -11,   7,  26,  24,  35,  -8, -20,
+        -36, -26, -12,  -1,   9,  -7,   6, -23,
+        -45, -25, -16, -17,   3,   0,  -5, -33,
+        -44, -16, -20,  -9,  -1,  11,  -6, -71,
+        -19, -13,   1,  17,  16,   7, -37, -26,
+    },
+    {
+        -28,   0,  29,  12,  59,  44,  43,  45,
+        -24, -39,  -5,   1, -16,  57,  28,  54,
+        -13, -17,   7,   8,  29,  56,  47,  57,
+        -27, -27, -16, -16,  -1,  17,  -2,   1,
+         -9, -26,  -9, -10,  -2,  -4,   3,  -3,
+        -14,   2, -11,  -2,  -5,   2,  14,   5,
+        -35,  -8,  11,   2,   8,  15,  -3,   1,
+         -1, -18,  -9,  10, -15, -25, -31, -50,
+    },
+    {
+        -65,  23,  16, -15, -56, -34,   2,  13,
+         29,  -1, -20,  -7,  -8,  -4, -38, -29,
+         -9,  24,   2, -16, -20,   6,  22, -22,
+        -17, -20, -12, -27, -30, -25, -14, -36,
+        -49,  -1, -27, -39, -46, -44, -33, -51,
+        -14, -14, -22, -46, -44, -30, -15, -27,
+          1,   7,  -8, -64, -43, -16,   9,   8,
+        -15,  36,  12, -54,   8, -28,  24,  14,
+    },
+};
+
+static const int kEndGameTables[7][64] = {
+    {},
+    {
+          0,   0,   0,   0,   0,   0,   0,   0,
+        178, 173, 158, 134, 147, 132, 165, 187,
+         94, 100,  85,  67,  56,  53,  82,  84,
+         32,  24,  13,   5,  -2,   4,  17,  17,
+         13,   9,  -3,  -7,  -7,  -8,   3,  -1,
+          4,   7,  -6,   1,   0,  -5,  -1,  -8,
+         13,   8,   8,  10,  13,   0,   2,  -7,
+          0,   0,   0,   0,   0,   0,   0,   0,
+    },
+    {
+        -58, -38, -13, -28, -31, -27, -63, -99,
+        -25,  -8, -25,  -2,  -9, -25, -24, -52,
+        -24, -20,  10,   9,  -1,  -9, -19, -41,
+        -17,   3,  22,  22,  22,  11,   8, -18,
+        -18,  -6,  16,  25,  16,  17,   4, -18,
+        -23,  -3,  -1,  15,  10,  -3, -20, -22,
+        -42, -20, -10,  -5,  -2, -20, -23, -44,
+        -29, -51, -23, -15, -22, -18, -50, -64,
+    },
+    {
+        -14, -21, -11,  -8,  -7,  -9, -17, -24,
+         -8,  -4,   7, -12,  -3, -13,  -4, -14,
+          2,  -8,   0,  -1,  -2,   6,   0,   4,
+         -3,   9,  12,   9,  14,  10,   3,   2,
+         -6,   3,  13,  19,   7,  10,  -3,  -9,
+        -12,  -3,   8,  10,  13,   3,  -7, -15,
+        -14, -18,  -7,  -1,   4,  -9, -15, -27,
+        -23,  -9, -23,  -5,  -9, -16,  -5, -17,
+    },
+    {
+         13,  10,  18,  15,  12,  12,   8,   5,
+         11,  13,  13,  11,  -3,   3,   8,   3,
+          7,   7,   7,   5,   4,  -3,  -5,  -3,
+          4,   3,  13,   1,   2,   1,  -1,   2,
+          3,   5,   8,   4,  -5,  -6,  -8, -11,
+         -4,   0,  -5,  -1,  -7, -12,  -8, -16,
+         -6,  -6,   0,   2,  -9,  -9, -11,  -3,
+         -9,   2,   3,  -1,  -5, -13,   4, -20,
+    },
+    {
+         -9,  22,  22,  27,  27,  19,  10,  20,
+        -17,  20,  32,  41,  58,  25,  30,   0,
+        -20,   6,   9,  49,  47,  35,  19,   9,
+          3,  22,  24,  45,  57,  40,  57,  36,
+        -18,  28,  19,  47,  31,  34,  39,  23,
+        -16, -27,  15,   6,   9,  17,  10,   5,
+        -22, -23, -30, -16, -16, -23, -36, -32,
+        -33, -28, -22, -43,  -5, -32, -20, -41,
+    },
+    {
+        -74, -35, -18, -18, -11,  15,   4, -17,
+        -12,  17,  14,  17,  17,  38,  23,  11,
+         10,  17,  23,  15,  20,  45,  44,  13,
+         -8,  22,  24,  27,  26,  33,  26,   3,
+        -18,  -4,  21,  24,  27,  23,   9, -11,
+        -19,  -3,  11,  21,  23,  16,   7,  -9,
+        -27, -11,   4,  13,  14,   4,  -5, -17,
+        -53, -34, -21, -11, -28, -14, -24, -43,
+    },
+};
+
+//
+// attack tables, magic numbers for the sliders and zobrist keys, all built once at startup
+// a slider's attacks are looked up by multiplying the blockers on its lines by a magic number,
+// the top bits of the product index a table that holds every possible answer for that square
+//
+struct ChessTables
+{
+    struct Magic
+    {
+        uint64_t    mask;       // squares whose blockers matter, board edges left off
+        uint64_t    magic;
+        int         shift;
+        int         offset;     // where this square's answers start in attacks
+    };
+
+    uint64_t    knight[64];
+    uint64_t    king[64];
+    uint64_t    pawn[2][64];        // squares a pawn of each colour attacks
+    uint64_t    between[64][64];    // squares strictly between two squares on a line, else 0
+    uint64_t    line[64][64];       // the whole line through two squares, else 0
+    Magic       rook[64];
+    Magic       bishop[64];
+    std::vector<uint64_t> attacks;
+
+    uint64_t    zobristPiece[16][64];
+    uint64_t    zobristSide;
+    uint64_t    zobristCastling[16];
+    uint64_t    zobristEnPassant[8];
+    // castling rights that survive a move touching each square
+    int         castlingKeep[64];
+    // piece value plus placement by piece and square, both colours scored as positive numbers
+    int         middleGame[16][64];
+    int         endGame[16][64];
+
+    ChessTables()
+    {
+        const int knightSteps[8][2] = { {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2} };
+        for (int square = 0; square < 64; square++) {
+            int file = square % 8, rank = square / 8;
+            knight[square] = king[square] = 0;
+            for (int i = 0; i < 8; i++) {
+                knight[square] |= stepBit(file + knightSteps[i][0], rank + knightSteps[i][1]);
+            }
+            for (int df = -1; df <= 1; df++) {
+                for (int dr = -1; dr <= 1; dr++) {
+                    if (df || dr) {
+                        king[square] |= stepBit(file + df, rank + dr);
+                    }
+                }
+            }
+            pawn[0][square] = stepBit(file - 1, rank + 1) | stepBit(file + 1, rank + 1);
+            pawn[1][square] = stepBit(file - 1, rank - 1) | stepBit(file + 1, rank - 1);
+        }
+
+        const int rookDirections[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+        const int bishopDirections[4][2] = { {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+        for (int from = 0; from < 64; from++) {
+            for (int to = 0; to < 64; to++) {
+                between[from][to] = line[from][to] = 0;
+            }
+            for (int d = 0; d < 8; d++) {
+                const int *direction = d < 4 ? rookDirections[d] : bishopDirections[d - 4];
+                uint64_t ray = 0;
+                int file = from % 8 + direction[0], rank = from / 8 + direction[1];
+                for (; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += direction[0], rank += direction[1]) {
+                    int to = rank * 8 + file;
+                    between[from][to] = ray;
+                    ray |= squareBit(to);
+                }
+            }
+        }
+        for (int from = 0; from < 64; from++) {
+            for (int to = 0; to < 64; to++) {
+                if (from == to) {
+                    continue;
+                }
+                uint64_t forward = 0;
+                bool onLine = false;
+                for (int d = 0; d < 8 && !onLine; d++) {
+                    const int *direction = d < 4 ? rookDirections[d] : bishopDirections[d - 4];
+                    uint64_t whole = squareBit(from) | slide(from, direction, 0) | slide(from, direction, 0, true);
+                    if (whole & squareBit(to)) {
+                        forward = whole;
+                        onLine = true;
+                    }
+                }
+                line[from][to] = forward;
+            }
+        }
+
+        uint64_t seed = 0x45d3a1c2b9e8f071ULL;
+        for (int square = 0; square < 64; square++) {
+            _findMagic(rook[square], square, rookDirections, seed);
+        }
+        for (int square = 0; square < 64; square++) {
+            _findMagic(bishop[square], square, bishopDirections, seed);
+        }
+
+        for (int piece = 0; piece < 16; piece++) {
+            for (int square = 0; square < 64; square++) {
+                zobristPiece[piece][square] = mixHash(seed++);
+            }
+        }
+        zobristSide = mixHash(seed++);
+        for (int i = 0; i < 16; i++) {
+            zobristCastling[i] = mixHash(seed++);
+        }
+        for (int i = 0; i < 8; i++) {
+            zobristEnPassant[i] = mixHash(seed++);
+        }
+
+        for (int square = 0; square < 64; square++) {
+            castlingKeep[square] = 15;
+        }
+        castlingKeep[0] &= ~ChessPosition::WHITE_QUEEN_SIDE;
+        castlingKeep[7] &= ~ChessPosition::WHITE_KING_SIDE;
+        castlingKeep[4] &= ~(ChessPosition::WHITE_KING_SIDE | ChessPosition::WHITE_QUEEN_SIDE);
+        castlingKeep[56] &= ~ChessPosition::BLACK_QUEEN_SIDE;
+        castlingKeep[63] &= ~ChessPosition::BLACK_KING_SIDE;
+        castlingKeep[60] &= ~(ChessPosition::BLACK_KING_SIDE | ChessPosition::BLACK_QUEEN_SIDE);
+
+        for (int piece = 0; piece < 16; piece++) {
+            int type = piece & 7;
+            for (int square = 0; square < 64; square++) {
+                middleGame[piece][square] = endGame[piece][square] = 0;
+                if (type == 0 || type == 7) {
+                    continue;
+                }
+                // the tables start at a8, so white reads them upside down and black reads them as they are
+                int index = (piece & ChessPosition::BLACK) ? square : square ^ 56;
+                middleGame[piece][square] = kMiddleGameValue[type] + kMiddleGameTables[type][index];
+                endGame[piece][square] = kEndGameValue[type] + kEndGameTables[type][index];
+            }
+        }
+    }
+
+    static uint64_t stepBit(int file, int rank)
+    {
+        return (file >= 0 && file < 8 && rank >= 0 && rank < 8) ? squareBit(rank * 8 + file) : 0;
+    }
+
+    // squares a slider reaches going one way until it hits a blocker, backwards runs the other way
+    static uint64_t slide(int square, const int *direction, uint64_t blockers, bool backwards = false)
+    {
+        int df = backwards ? -direction[0] : direction[0];
+        int dr = backwards ? -direction[1] : direction[1];
+        uint64_t ray = 0;
+        int file = square % 8 + df, rank = square / 8 + dr;
+        for (; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += df, rank += dr) {
+            ray |= squareBit(rank * 8 + file);
+            if (blockers & squareBit(rank * 8 + file)) {
+                break;
+            }
+        }
+        return ray;
+    }
+
+    static uint64_t slowAttacks(int square, const int (*directions)[2], uint64_t blockers)
+    {
+        uint64_t result = 0;
+        for (int d = 0; d < 4; d++) {
+            result |= slide(square, directions[d], blockers);
+        }
+        return result;
+    }
+
+    //
+    // try sparse random numbers until one sends every blocker pattern that gives a different answer to a different slot
+    //
+    void _findMagic(Magic &entry, int square, const int (*directions)[2], uint64_t &seed)
+    {
+        // a blocker on the last square of a ray never changes the answer, so the edges are left off
+        uint64_t mask = 0;
+        for (int d = 0; d < 4; d++) {
+            int df = directions[d][0], dr = directions[d][1];
+            int file = square % 8 + df, rank = square / 8 + dr;
+            for (; file + df >= 0 && file + df < 8 && rank + dr >= 0 && rank + dr < 8; file += df, rank += dr) {
+                mask |= squareBit(rank * 8 + file);
+            }
+        }
+        int bits = popCount(mask);
+        int size = 1 << bits;
+
+        // every subset of the mask and what a slider sees with it
+        std::vector<uint64_t> blockers(size), answers(size);
+        uint64_t subset = 0;
+        for (int i = 0; i < size; i++) {
+            blockers[i] = subset;
+            answers[i] = slowAttacks(square, directions, subset);
+            subset = (subset - mask) & mask;
+        }
+
+        entry.mask = mask;
+        entry.shift = 64 - bits;
+        entry.offset = (int)attacks.size();
+        attacks.resize(attacks.size() + size);
+        std::vector<int> used(size, 0);
+        for (int attempt = 1;; attempt++) {
+            uint64_t magic = mixHash(seed++);
+            magic &= mixHash(seed++);
+            magic &= mixHash(seed++);
+            if (popCount((mask * magic) >> 56) < 6) {
+                continue;
+            }
+            bool collided = false;
+            for (int i = 0; i < size && !collided; i++) {
+                int index = (int)((blockers[i] * magic) >> entry.shift);
+                uint64_t &slot = attacks[entry.offset + index];
+                if (used[index] != attempt) {
+                    used[index] = attempt;
+                    slot = answers[i];
+                } else if (slot != answers[i]) {
+                    collided = true;
+                }
+            }
+            if (!collided) {
+                entry.magic = magic;
+                return;
+            }
+        }
+    }
+
+    uint64_t rookAttacks(int square, uint64_t occupied) const
+    {
+        const Magic &m = rook[square];
+        return attacks[m.offset + (((occupied & m.mask) * m.magic) >> m.shift)];
+    }
+
+    uint64_t bishopAttacks(int square, uint64_t occupied) const
+    {
+        const Magic &m = bishop[square];
+        return attacks[m.offset + (((occupied & m.mask) * m.magic) >> m.shift)];
+    }
+};
+
+static const ChessTables kTables;
+
+static const char kPieceLetters[] = ".PNBRQK..pnbrqk";
+ChessPosition::ChessPosition()
+{
+    reset();
+}
+
+void ChessPosition::reset()
+{
+    setStateString(START_POSITION);
+}
+
+void ChessPosition::_put(int piece, int square)
+{
+    _board[square] = (uint8_t)piece;
+    _pieces[piece] |= squareBit(square);
+    _colors[pieceColor(piece)] |= squareBit(square);
+    _hash ^= kTables.zobristPiece[piece][square];
+    _middleGame[pieceColor(piece)] += kTables.middleGame[piece][square];
+    _endGame[pieceColor(piece)] += kTables.endGame[piece][square];
+    _phase += kPhaseWeight[pieceType(piece)];
+}
+
+void ChessPosition::_remove(int square)
+{
+    int piece = _board[square];
+    _board[square] = EMPTY;
+    _pieces[piece] &= ~squareBit(square);
+    _colors[pieceColor(piece)] &= ~squareBit(square);
+    _hash ^= kTables.zobristPiece[piece][square];
+    _middleGame[pieceColor(piece)] -= kTables.middleGame[piece][square];
+    _endGame[pieceColor(piece)] -= kTables.endGame[piece][square];
+    _phase -= kPhaseWeight[pieceType(piece)];
+}
+
+void ChessPosition::_computeHash()
+{
+    _hash = 0;
+    for (int square = 0; square < 64; square++) {
+        if (_board[square] != EMPTY) {
+            _hash ^= kTables.zobristPiece[_board[square]][square];
+        }
+    }
+    if (_side == 1) {
+        _hash ^= kTables.zobristSide;
+    }
+    _hash ^= kTables.zobristCastling[_castling];
+    if (_enPassant >= 0) {
+        _hash ^= kTables.zobristEnPassant[_enPassant % 8];
+    }
+}
+
+void ChessPosition::setSideToMove(int side)
+{
+    _side = side;
+    if (_plies == 0) {
+        _firstSide = side;
+    }
+    _enPassant = -1;
+    _computeHash();
+}
+
+uint64_t ChessPosition::_attackersOf(int square, uint64_t occupied) const
+{
+    uint64_t diagonal = _pieces[BISHOP] | _pieces[QUEEN] | _pieces[BISHOP | BLACK] | _pieces[QUEEN | BLACK];
+    uint64_t straight = _pieces[ROOK] | _pieces[QUEEN] | _pieces[ROOK | BLACK] | _pieces[QUEEN | BLACK];
+    return (kTables.pawn[1][square] & _pieces[PAWN]) |
+           (kTables.pawn[0][square] & _pieces[PAWN | BLACK]) |
+           (kTables.knight[square] & (_pieces[KNIGHT] | _pieces[KNIGHT | BLACK])) |
+           (kTables.king[square] & (_pieces[KING] | _pieces[KING | BLACK])) |
+           (kTables.bishopAttacks(square, occupied) & diagonal) |
+           (kTables.rookAttacks(square, occupied) & straight);
+}
+
+bool ChessPosition::attacked(int square, int player) const
+{
+    return (_attackersOf(square, _colors[0] | _colors[1]) & _colors[player]) != 0;
+}
+
+bool ChessPosition::inCheck() const
+{
+    return attacked(lowestBit(_pieces[KING | (_side * BLACK)]), 1 - _side);
+}
+
+uint64_t ChessPosition::_pinned() const
+{
+    int us = _side * BLACK, them = (1 - _side) * BLACK;
+    int king = lowestBit(_pieces[KING | us]);
+    uint64_t occupied = _colors[0] | _colors[1];
+    // enemy sliders that would see the king through an empty board
+    uint64_t snipers = (kTables.rookAttacks(king, 0) & (_pieces[ROOK | them] | _pieces[QUEEN | them])) |
+                       (kTables.bishopAttacks(king, 0) & (_pieces[BISHOP | them] | _pieces[QUEEN | them]));
+    uint64_t pinned = 0;
+    while (snipers) {
+        int sniper = lowestBit(snipers);
+        snipers &= snipers - 1;
+        uint64_t blockers = kTables.between[king][sniper] & occupied;
+        if (blockers && !(blockers & (blockers - 1))) {
+            pinned |= blockers & _colors[_side];
+        }
+    }
+    return pinned;
+}
+
+// taking en passant clears two pieces off one rank, easiest to just try it
+bool ChessPosition::_enPassantLegal(int from, int to) const
+{
+    int king = lowestBit(_pieces[KING | (_side * BLACK)]);
+    int victim = to + (_side == 0 ? -8 : 8);
+    uint64_t occupied = ((_colors[0] | _colors[1]) ^ squareBit(from) ^ squareBit(victim)) | squareBit(to);
+    uint64_t enemies = _colors[1 - _side] ^ squareBit(victim);
+    int them = (1 - _side) * BLACK;
+    return !(kTables.rookAttacks(king, occupied) & (_pieces[ROOK | them] | _pieces[QUEEN | them]) & enemies) &&
+           !(kTables.bishopAttacks(king, occupied) & (_pieces[BISHOP | them] | _pieces[QUEEN | them]) & enemies) &&
+           !(kTables.knight[king] & _pieces[KNIGHT | them]) &&
+           !(kTables.pawn[_side][king] & _pieces[PAWN | them] & enemies);
+}
+
+void ChessPosition::_addPawnMove(Moves &list, int from, int to, bool capture) const
+{
+    if (to >= 56 || to < 8) {
+        int kind = capture ? Move::PROMOTION_CAPTURE : Move::PROMOTION;
+        // queen first, it's nearly always the one wanted
+        for (int piece = 3; piece >= 0; piece--) {
+            list.push(Move(from, to, kind + piece));
+        }
+    } else {
+        list.push(Move(from, to, capture ? Move::CAPTURE : Move::QUIET));
+    }
+}
+
+void ChessPosition::moves(Moves &list) const
+{
+    _generate(list, true);
+}
+
+void ChessPosition::captures(Moves &list) const
+{
+    _generate(list, false);
+}
+
+void ChessPosition::_generate(Moves &list, bool quiets) const
+{
+    list.clear();
+    int us = _side * BLACK;
+    uint64_t own = _colors[_side], enemy = _colors[1 - _side];
+    uint64_t occupied = own | enemy;
+    int king = lowestBit(_pieces[KING | us]);
+
+    // the king can't step anywhere attacked once it has moved, so look with it off the board
+    uint64_t withoutKing = occupied ^ squareBit(king);
+    // without quiets only squares holding an enemy are worth going to
+    uint64_t wanted = quiets ? ~own : enemy;
+    uint64_t targets = kTables.king[king] & wanted;
+    while (targets) {
+        int to = lowestBit(targets);
+        targets &= targets - 1;
+        if (!(_attackersOf(to, withoutKing) & enemy)) {
+            list.push(Move(king, to, (enemy & squareBit(to)) ? Move::CAPTURE : Move::QUIET));
+        }
+    }
+
+    uint64_t checkers = _attackersOf(king, occupied) & enemy;
+    if (checkers & (checkers - 1)) {
+        // double check, only the king can do anything about it
+        return;
+    }
+    // out of check every other move has to take the checker or get in its way
+    uint64_t checkMask = ~0ULL;
+    if (checkers) {
+        checkMask = checkers | kTables.between[king][lowestBit(checkers)];
+    }
+    uint64_t allowed = wanted & checkMask;
+    uint64_t pinned = _pinned();
+
+    for (int type = KNIGHT; type <= QUEEN; type++) {
+        uint64_t pieces = _pieces[type | us];
+        while (pieces) {
+            int from = lowestBit(pieces);
+            pieces &= pieces - 1;
+            uint64_t reach;
+            switch (type) {
+            case KNIGHT: reach = kTables.knight[from]; break;
+            case BISHOP: reach = kTables.bishopAttacks(from, occupied); break;
+            case ROOK:   reach = kTables.rookAttacks(from, occupied); break;
+            default:     reach = kTables.bishopAttacks(from, occupied) | kTables.rookAttacks(from, occupied); break;
+            }
+            reach &= allowed;
+            if (pinned & squareBit(from)) {
+                reach &= kTables.line[king][from];
+            }
+            while (reach) {
+                int to = lowestBit(reach);
+                reach &= reach - 1;
+                list.push(Move(from, to, (enemy & squareBit(to)) ? Move::CAPTURE : Move::QUIET));
+            }
+        }
+    }
+
+    int forward = _side == 0 ? 8 : -8;
+    int startRank = _side == 0 ? 1 : 6;
+    // pushes onto the last rank are promotions and count as noisy
+    uint64_t lastRank = _side == 0 ? 0xff00000000000000ULL : 0xffULL;
+    uint64_t pawns = _pieces[PAWN | us];
+    while (pawns) {
+        int from = lowestBit(pawns);
+        pawns &= pawns - 1;
+        uint64_t legal = checkMask;
+        if (pinned & squareBit(from)) {
+            legal &= kTables.line[king][from];
+        }
+        int to = from + forward;
+        if (!(occupied & squareBit(to))) {
+            if ((legal & squareBit(to)) && (quiets || (lastRank & squareBit(to)))) {
+                _addPawnMove(list, from, to, false);
+            }
+            int twice = to + forward;
+            if (quiets && from / 8 == startRank && !(occupied & squareBit(twice)) && (legal & squareBit(twice))) {
+                list.push(Move(from, twice, Move::DOUBLE_PUSH));
+            }
+        }
+        uint64_t captures = kTables.pawn[_side][from] & enemy & legal;
+        while (captures) {
+            int target = lowestBit(captures);
+            captures &= captures - 1;
+            _addPawnMove(list, from, target, true);
+        }
+        if (_enPassant >= 0 && (kTables.pawn[_side][from] & squareBit(_enPassant)) && _enPassantLegal(from, _enPassant)) {
+            list.push(Move(from, _enPassant, Move::EN_PASSANT));
+        }
+    }
+
+    // castling, the king may not start, cross or land on an attacked square
+    if (quiets && !checkers) {
+        int rights = _castling >> (_side * 2);
+        if ((rights & WHITE_KING_SIDE) && !(occupied & kTables.between[king][king + 3]) &&
+            !(_attackersOf(king + 1, occupied) & enemy) && !(_attackersOf(king + 2, occupied) & enemy)) {
+            list.push(Move(king, king + 2, Move::KING_CASTLE));
+        }
+        if ((rights & WHITE_QUEEN_SIDE) && !(occupied & kTables.between[king][king - 4]) &&
+            !(_attackersOf(king - 1, occupied) & enemy) && !(_attackersOf(king - 2, occupied) & enemy)) {
+            list.push(Move(king, king - 2, Move::QUEEN_CASTLE));
+        }
+    }
+}
+
+void ChessPosition::play(const Move &move)
+{
+    Undo &undo = _undo[_plies % MAX_PLIES];
+    undo.hash = _hash;
+    undo.castling = (uint8_t)_castling;
+    undo.enPassant = (int8_t)_enPassant;
+    undo.quietPlies = (uint16_t)_quietPlies;
+    undo.captured = EMPTY;
+
+    int from = move.from(), to = move.to(), kind = move.kind();
+    int piece = _board[from];
+    _quietPlies++;
+    if (kind == Move::EN_PASSANT) {
+        int victim = to + (_side == 0 ? -8 : 8);
+        undo.captured = _board[victim];
+        _remove(victim);
+    } else if (move.isCapture()) {
+        undo.captured = _board[to];
+        _remove(to);
+    }
+    _remove(from);
+    _put(move.isPromotion() ? move.promotion() | (_side * BLACK) : piece, to);
+    if (kind == Move::KING_CASTLE) {
+        _put(_board[from + 3], from + 1);
+        _remove(from + 3);
+    } else if (kind == Move::QUEEN_CASTLE) {
+        _put(_board[from - 4], from - 1);
+        _remove(from - 4);
+    }
+    if (pieceType(piece) == PAWN || move.isCapture()) {
+        _quietPlies = 0;
+    }
+
+    _hash ^= kTables.zobristCastling[_castling];
+    _castling &= kTables.castlingKeep[from] & kTables.castlingKeep[to];
+    _hash ^= kTables.zobristCastling[_castling];
+    if (_enPassant >= 0) {
+        _hash ^= kTables.zobristEnPassant[_enPassant % 8];
+    }
+    _enPassant = kind == Move::DOUBLE_PUSH ? (from + to) / 2 : -1;
+    if (_enPassant >= 0) {
+        _hash ^= kTables.zobristEnPassant[_enPassant % 8];
+    }
+    _side = 1 - _side;
+    _hash ^= kTables.zobristSide;
+    _plies++;
+}
+
+void ChessPosition::undo(const Move &move)
+{
+    _plies--;
+    _side = 1 - _side;
+    const Undo &undo = _undo[_plies % MAX_PLIES];
+
+    int from = move.from(), to = move.to(), kind = move.kind();
+    int piece = move.isPromotion() ? PAWN | (_side * BLACK) : _board[to];
+    _remove(to);
+    _put(piece, from);
+    if (kind == Move::KING_CASTLE) {
+        _put(_board[from + 1], from + 3);
+        _remove(from + 1);
+    } else if (kind == Move::QUEEN_CASTLE) {
+        _put(_board[from - 1], from - 4);
+        _remove(from - 1);
+    }
+    if (kind == Move::EN_PASSANT) {
+        _put(undo.captured, to + (_side == 0 ? -8 : 8));
+    } else if (move.isCapture()) {
+        _put(undo.captured, to);
+    }
+
+    _castling = undo.castling;
+    _enPassant = undo.enPassant;
+    _quietPlies = undo.quietPlies;
+    _hash = undo.hash;
+}
+
+void ChessPosition::playNull()
+{
+    Undo &undo = _undo[_plies % MAX_PLIES];
+    undo.hash = _hash;
+    undo.castling = (uint8_t)_castling;
+    undo.enPassant = (int8_t)_enPassant;
+    undo.quietPlies = (uint16_t)_quietPlies;
+    undo.captured = EMPTY;
+
+    if (_enPassant >= 0) {
+        _hash ^= kTables.zobristEnPassant[_enPassant % 8];
+        _enPassant = -1;
+    }
+    // positions either side of a null move aren't real repetitions
+    _quietPlies = 0;
+    _side = 1 - _side;
+    _hash ^= kTables.zobristSide;
+    _plies++;
+}
+
+void ChessPosition::undoNull()
+{
+    _plies--;
+    _side = 1 - _side;
+    const Undo &undo = _undo[_plies % MAX_PLIES];
+    _enPassant = undo.enPassant;
+    _quietPlies = undo.quietPlies;
+    _hash = undo.hash;
+}
+
+bool ChessPosition::isDraw(int repetitions) const
+{
+    if (_quietPlies >= DRAW_PLIES) {
+        return true;
+    }
+
+    // only kings, or kings and a single knight or bishop
+    uint64_t heavy = _pieces[PAWN] | _pieces[ROOK] | _pieces[QUEEN] |
+                     _pieces[PAWN | BLACK] | _pieces[ROOK | BLACK] | _pieces[QUEEN | BLACK];
+    if (!heavy && popCount(_colors[0] | _colors[1]) <= 3) {
+        return true;
+    }
+
+    // the same position again, only positions since the last capture or pawn move can repeat
+    int lookBack = _quietPlies < _plies ? _quietPlies : _plies;
+    if (lookBack > MAX_PLIES) {
+        lookBack = MAX_PLIES;
+    }
+    int seen = 0;
+    for (int back = 2; back <= lookBack; back += 2) {
+        if (_undo[(_plies - back) % MAX_PLIES].hash == _hash && ++seen == repetitions - 1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ChessPosition::gameOver() const
+{
+    if (isDraw()) {
+        return true;
+    }
+    Moves list;
+    moves(list);
+    return list.empty();
+}
+
+int ChessPosition::winner() const
+{
+    Moves list;
+    moves(list);
+    if (!list.empty() || !inCheck()) {
+        return -1;
+    }
+    return 1 - _side;
+}
+
+int ChessPosition::eval() const
+{
+    int us = _side, them = 1 - _side;
+    // promotions can push the phase past a full board
+    int phase = _phase < 24 ? _phase : 24;
+    int middleGame = _middleGame[us] - _middleGame[them];
+    int endGame = _endGame[us] - _endGame[them];
+    return (middleGame * phase + endGame * (24 - phase)) / 24;
+}
+
+bool ChessPosition::hasPieces(int player) const
+{
+    int color = player * BLACK;
+    return (_pieces[KNIGHT | color] | _pieces[BISHOP | color] | _pieces[ROOK | color] | _pieces[QUEEN | color]) != 0;
+}
+
+static std::string squareName(int square)
+{
+    std::string name;
+    name += (char)('a' + square % 8);
+    name += (char)('1' + square / 8);
+    return name;
+}
+
+std::string ChessPosition::stateString() const
+{
+    std::string s;
+    for (int rank = 7; rank >= 0; rank--) {
+        int empty = 0;
+        for (int file = 0; file < 8; file++) {
+            int piece = _board[rank * 8 + file];
+            if (piece == EMPTY) {
+                empty++;
+                continue;
+            }
+            if (empty) {
+                s += (char)('0' + empty);
+                empty = 0;
+            }
+            s += kPieceLetters[piece];
+        }
+        if (empty) {
+            s += (char)('0' + empty);
+        }
+        if (rank > 0) {
+            s += '/';
+        }
+    }
+
+    s += _side == 0 ? " w " : " b ";
+    if (_castling == 0) {
+        s += '-';
+    }
+    if (_castling & WHITE_KING_SIDE) s += 'K';
+    if (_castling & WHITE_QUEEN_SIDE) s += 'Q';
+    if (_castling & BLACK_KING_SIDE) s += 'k';
+    if (_castling & BLACK_QUEEN_SIDE) s += 'q';
+    s += ' ';
+    s += _enPassant >= 0 ? squareName(_enPassant) : "-";
+    s += ' ' + std::to_string(_quietPlies) + ' ' + std::to_string(_firstMove + (_plies + _firstSide) / 2);
+    return s;
+}
+
+//
+// board, side, castling and en passant are read strictly, the two move counters may be left off
+//
+bool ChessPosition::setStateString(const std::string &s)
+{
+    std::istringstream fields(s);
+    std::string placement, side = "w", castling = "-", enPassant = "-";
+    int quietPlies = 0, fullMove = 1;
+    if (!(fields >> placement)) {
+        return false;
+    }
+    fields >> side >> castling >> enPassant;
+    if (fields >> quietPlies) {
+        fields >> fullMove;
+    }
+
+    uint8_t board[64];
+    for (int square = 0; square < 64; square++) {
+        board[square] = EMPTY;
+    }
+    int kings[2] = { 0, 0 };
+    int rank = 7, file = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            if (file != 8 || rank == 0) {
+                return false;
+            }
+            rank--;
+            file = 0;
+        } else if (c >= '1' && c <= '8') {
+            file += c - '0';
+            if (file > 8) {
+                return false;
+            }
+        } else {
+            int piece = 1;
+            while (piece < 16 && (kPieceLetters[piece] != c || c == '.')) {
+                piece++;
+            }
+            if (piece == 16 || file > 7) {
+                return false;
+            }
+            int square = rank * 8 + file;
+            // pawns never stand on the first or last rank
+            if (pieceType(piece) == PAWN && (square < 8 || square >= 56)) {
+                return false;
+            }
+            if (pieceType(piece) == KING) {
+                kings[pieceColor(piece)]++;
+            }
+            board[square] = (uint8_t)piece;
+            file++;
+        }
+    }
+    if (rank != 0 || file != 8 || kings[0] != 1 || kings[1] != 1) {
+        return false;
+    }
+    if (side != "w" && side != "b") {
+        return false;
+    }
+    int rights = 0;
+    if (castling != "-") {
+        for (char c : castling) {
+            const char *letters = "KQkq";
+            const char *found = strchr(letters, c);
+            if (!c || !found) {
+                return false;
+            }
+            rights |= 1 << (found - letters);
+        }
+    }
+    int passed = -1;
+    if (enPassant != "-") {
+        if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' || (enPassant[1] != '3' && enPassant[1] != '6')) {
+            return false;
+        }
+        passed = (enPassant[1] - '1') * 8 + (enPassant[0] - 'a');
+    }
+
+    for (int piece = 0; piece < 16; piece++) {
+        _pieces[piece] = 0;
+    }
+    _colors[0] = _colors[1] = 0;
+    _middleGame[0] = _middleGame[1] = _endGame[0] = _endGame[1] = _phase = 0;
+    for (int square = 0; square < 64; square++) {
+        _board[square] = EMPTY;
+        if (board[square] != EMPTY) {
+            _put(board[square], square);
+        }
+    }
+    // rights without the king and rook still at home would castle pieces that aren't there
+    _castling = 0;
+    if (_board[4] == KING) {
+        if (_board[7] == ROOK) _castling |= rights & WHITE_KING_SIDE;
+        if (_board[0] == ROOK) _castling |= rights & WHITE_QUEEN_SIDE;
+    }
+    if (_board[60] == (KING | BLACK)) {
+        if (_board[63] == (ROOK | BLACK)) _castling |= rights & BLACK_KING_SIDE;
+        if (_board[56] == (ROOK | BLACK)) _castling |= rights & BLACK_QUEEN_SIDE;
+    }
+    _side = side == "b" ? 1 : 0;
+    _enPassant = passed;
+    _quietPlies = quietPlies >= 0 ? quietPlies : 0;
+    _plies = 0;
+    _firstMove = fullMove > 0 ? fullMove : 1;
+    _firstSide = _side;
+    _computeHash();
+    return true;
+}
+
+std::string ChessPosition::moveToString(const Move &move) const
+{
+    std::string text = squareName(move.from()) + squareName(move.to());
+    if (move.isPromotion()) {
+        text += "nbrq"[move.promotion() - KNIGHT];
+    }
+    return text;
+}
+
+bool ChessPosition::parseMove(const std::string &text, Move &move) const
+{
+    Moves list;
+    moves(list);
+    for (const Move &candidate : list) {
+        if (moveToString(candidate) == text) {
+            move = candidate;
+            return true;
+        }
+    }
+    return false;
+}
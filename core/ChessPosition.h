@@ -0,0 +1,169 @@
+#pragma once
+#include "MoveList.h"
+#include <cstdint>
+#include <string>
+
+//
+// a chess move packed into 16 bits, from and to squares plus what kind of move it is
+//
+struct ChessMove
+{
+    // kinds, promotions keep the piece in the low two bits and captures set bit 2
+    static const int QUIET = 0;
+    static const int DOUBLE_PUSH = 1;
+    static const int KING_CASTLE = 2;
+    static const int QUEEN_CASTLE = 3;
+    static const int CAPTURE = 4;
+    static const int EN_PASSANT = 5;
+    static const int PROMOTION = 8;         // + 0 knight, 1 bishop, 2 rook, 3 queen
+    static const int PROMOTION_CAPTURE = 12;
+
+    uint16_t    data = 0;
+
+    ChessMove() {}
+    ChessMove(int from, int to, int kind) : data((uint16_t)(from | (to << 6) | (kind << 12))) {}
+
+    int         from() const { return data & 63; }
+    int         to() const { return (data >> 6) & 63; }
+    int         kind() const { return data >> 12; }
+    bool        isCapture() const { return (kind() & CAPTURE) != 0; }
+    bool        isPromotion() const { return (kind() & PROMOTION) != 0; }
+    bool        isCastle() const { return kind() == KING_CASTLE || kind() == QUEEN_CASTLE; }
+    // piece type a pawn turns into, only meaningful for promotions
+    int         promotion() const;
+    bool operator==(const ChessMove &other) const { return data == other.data; }
+};
+
+// what a transposition table keeps, the move already fits
+inline uint16_t moveCode(const ChessMove &move)
+{
+    return move.data;
+}
+
+//
+// chess rules on bitboards, no rendering
+// square = rank * 8 + file with a1 = 0 and h8 = 63, player 0 is white and moves first
+// sliding attacks come from magic bitboard tables built once at startup
+// moves() only ever returns legal moves, checks and pins are worked out while generating
+//
+class ChessPosition
+{
+public:
+    // undo history is a ring, nothing needs to take back more plies than this
+    static const int MAX_PLIES = 1024;
+    // plies without a capture or pawn move before the game is drawn
+    static const int DRAW_PLIES = 100;
+    static constexpr const char *START_POSITION = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    // piece types, a piece is its type plus 8 for black
+    static const int EMPTY = 0;
+    static const int PAWN = 1;
+    static const int KNIGHT = 2;
+    static const int BISHOP = 3;
+    static const int ROOK = 4;
+    static const int QUEEN = 5;
+    static const int KING = 6;
+    static const int BLACK = 8;
+
+    // castling rights
+    static const int WHITE_KING_SIDE = 1;
+    static const int WHITE_QUEEN_SIDE = 2;
+    static const int BLACK_KING_SIDE = 4;
+    static const int BLACK_QUEEN_SIDE = 8;
+
+    typedef ChessMove Move;
+    typedef MoveList<Move, 256> Moves;
+
+    ChessPosition();
+
+    void        reset();
+
+    void        moves(Moves &list) const;
+    // just the legal captures and promotions, what a quiescence search looks at
+    void        captures(Moves &list) const;
+    void        play(const Move &move);
+    void        undo(const Move &move);
+    // hand the move to the other side without moving, for null move pruning, never while in check
+    void        playNull();
+    void        undoNull();
+
+    int         sideToMove() const { return _side; }
+    void        setSideToMove(int side);
+    int         plies() const { return _plies; }
+    bool        inCheck() const;
+    bool        gameOver() const;
+    // fifty moves, the position seen repetitions times or nobody left who can mate
+    // searches pass 2, a position that has come round once will come round again
+    bool        isDraw(int repetitions = 3) const;
+    // the side that mated, -1 while playing, on stalemate or on a draw
+    int         winner() const;
+    // tapered piece-square score from the side to move's point of view, PeSTO's tables
+    // kept up to date as pieces come and go, so this is only a blend of two sums
+    int         eval() const;
+    // true if player has anything besides pawns and the king, null moves are unsafe without
+    bool        hasPieces(int player) const;
+    uint64_t    hash() const { return _hash; }
+
+    // EMPTY or a piece, colour in the BLACK bit
+    int         pieceAt(int square) const { return _board[square]; }
+    static int  pieceType(int piece) { return piece & 7; }
+    static int  pieceColor(int piece) { return piece >> 3; }
+    int         castlingRights() const { return _castling; }
+    // square a pawn could take en passant on, -1 for none
+    int         enPassantSquare() const { return _enPassant; }
+    // true if player has a piece attacking square
+    bool        attacked(int square, int player) const;
+
+    // FEN, board, side to move, castling, en passant square, plies since a capture or pawn move and move number
+    std::string stateString() const;
+    bool        setStateString(const std::string &s);
+
+    // long algebraic, "e2e4", "e1g1" to castle and "e7e8q" to promote
+    std::string moveToString(const Move &move) const;
+    bool        parseMove(const std::string &text, Move &move) const;
+
+private:
+    struct Undo
+    {
+        uint64_t    hash;
+        uint8_t     captured;
+        uint8_t     castling;
+        int8_t      enPassant;
+        uint16_t    quietPlies;
+    };
+
+    void        _put(int piece, int square);
+    void        _remove(int square);
+    void        _computeHash();
+    uint64_t    _attackersOf(int square, uint64_t occupied) const;
+    // bitboard of pieces of the side to move that can't leave the line to their king
+    uint64_t    _pinned() const;
+    bool        _enPassantLegal(int from, int to) const;
+    // one move, or all four promotions when a pawn reaches the last rank
+    void        _addPawnMove(Moves &list, int from, int to, bool capture) const;
+    // every legal move, or with quiets false only the captures and promotions
+    void        _generate(Moves &list, bool quiets) const;
+
+    uint64_t    _pieces[16];        // by piece, white pieces 1-6 and black 9-14
+    uint64_t    _colors[2];
+    uint8_t     _board[64];
+    int         _side;
+    int         _castling;
+    int         _enPassant;
+    int         _quietPlies;
+    int         _plies;
+    // move number and side to move when the state string was set, for the FEN move counter
+    int         _firstMove;
+    int         _firstSide;
+    uint64_t    _hash;
+    // middle and end game piece-square sums for each side, and how much material is left
+    int         _middleGame[2];
+    int         _endGame[2];
+    int         _phase;
+    Undo        _undo[MAX_PLIES];
+};
+
+inline int ChessMove::promotion() const
+{
+    return ChessPosition::KNIGHT + (kind() & 3);
+}
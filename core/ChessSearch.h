@@ -0,0 +1,360 @@
+#pragma once
+#include "ChessPosition.h"
+#include "Search.h"
+#include <cmath>
+#include <concepts>
+
+//
+// chess needs more than the plain search to see past its first few moves
+// the shared principal variation search with aspiration windows, null move pruning, late move reductions,
+// killer and history ordering and a quiescence search on captures filled in through its hooks
+// works on ChessPosition or anything built on it, such as the tournament's eval variants
+//
+template <class Position>
+class ChessSearcher : public AlphaBeta<ChessSearcher<Position>, Position>
+{
+    typedef AlphaBeta<ChessSearcher<Position>, Position> Base;
+    friend Base;
+
+public:
+    typedef ChessMove Move;
+    typedef typename Position::Moves Moves;
+
+    // megabytes of transposition table
+    static const size_t DEFAULT_TABLE_MEGABYTES = 8;
+
+    ChessSearcher(size_t tableMegabytes = DEFAULT_TABLE_MEGABYTES) : Base(tableMegabytes)
+    {
+        // reductions grow with both depth and how late the move comes
+        for (int depth = 1; depth < SEARCH_MAX_PLY; depth++) {
+            for (int count = 1; count < MAX_ORDERED; count++) {
+                _reductions[depth][count] = (uint8_t)(0.75 + std::log((double)depth) * std::log((double)count) / 2.25);
+            }
+        }
+    }
+
+    void clearTable()
+    {
+        Base::clearTable();
+        _scaleHistory(0);
+    }
+
+protected:
+    using Base::_stats;
+    using Base::_stopped;
+    using Base::_limits;
+    using Base::_checkStop;
+    using Base::_pvLength;
+
+private:
+
+    // moves past this many are all reduced as much as the last
+    static const int MAX_ORDERED = 64;
+    // ordering scores, table move first, then winning captures, killers and the rest by history
+    static const int TABLE_MOVE_SCORE = 1 << 30;
+    static const int CAPTURE_SCORE = 1 << 24;
+    static const int KILLER_SCORE = 1 << 20;
+    static const int HISTORY_LIMIT = 1 << 16;
+
+    //
+    // the hooks the shared search calls
+    //
+
+    void onSearchStart()
+    {
+        for (auto &killers : _killers) {
+            killers[0] = killers[1] = Move();
+        }
+        // old history still helps, but the last search's should count for more
+        _scaleHistory(8);
+    }
+
+    // a narrow window around the last depth's score is cheap to search, widen it whenever the score falls outside
+    void rootWindow(int depth, int previous, int &alpha, int &beta)
+    {
+        _window = 25;
+        if (depth < 5 || isWinScore(previous)) {
+            alpha = -SEARCH_INFINITY;
+            beta = SEARCH_INFINITY;
+            return;
+        }
+        alpha = previous - _window;
+        beta = previous + _window;
+    }
+
+    bool widenRoot(int score, int &alpha, int &beta)
+    {
+        if (score <= alpha) {
+            alpha = score - _window;
+        } else if (score >= beta) {
+            beta = score + _window;
+        } else {
+            return false;
+        }
+        _window *= 2;
+        if (_window > 1000) {
+            alpha = -SEARCH_INFINITY;
+            beta = SEARCH_INFINITY;
+        }
+        return true;
+    }
+
+    // a mate found is a mate, and the next depth would rarely finish in the time that's left
+    bool keepDeepening(int depth, int score, int64_t now)
+    {
+        return !(isWinScore(score) && depth > 1) && !(_limits.movetime > 0 && now >= _limits.movetime * 1000 / 2);
+    }
+
+    // mates and stalemates show up as having no moves, only draws by rule need looking for
+    bool isTerminal(Position &position, int ply, int &score)
+    {
+        if (!position.isDraw(2)) {
+            return false;
+        }
+        score = 0;
+        return true;
+    }
+
+    // a check can't be left unanswered at the horizon
+    int extension(Position &position, int ply)
+    {
+        _inCheck[ply] = position.inCheck();
+        return _inCheck[ply] ? 1 : 0;
+    }
+
+    int leafScore(Position &position, int ply, int alpha, int beta) { return _quiesce(position, ply, alpha, beta); }
+
+    bool prune(Position &position, int depth, int ply, int alpha, int beta, int &score)
+    {
+        if (beta - alpha > 1 || _inCheck[ply]) {
+            return false;
+        }
+        _staticEval[ply] = position.eval();
+        // so far ahead that even a bad move here will still be good enough
+        if (depth <= 6 && _staticEval[ply] - 80 * depth >= beta && !isWinScore(beta)) {
+            score = _staticEval[ply];
+            return true;
+        }
+        return false;
+    }
+
+    // give the opponent a free move, if we're still winning a real move would win by more
+    // not with only pawns left, zugzwang is common there
+    int nullMoveReduction(Position &position, int depth, int ply, int alpha, int beta, bool nullMove)
+    {
+        // prune() has only looked at the eval when these let it
+        if (nullMove || depth < 3 || beta - alpha > 1 || _inCheck[ply]) {
+            return 0;
+        }
+        if (_staticEval[ply] < beta || !position.hasPieces(position.sideToMove())) {
+            return 0;
+        }
+        return 3 + depth / 6;
+    }
+
+    void playNull(Position &position) { position.playNull(); }
+    void undoNull(Position &position) { position.undoNull(); }
+
+    int noMovesScore(Position &position, int ply) { return _inCheck[ply] ? -(SEARCH_WIN_SCORE - ply) : 0; }
+
+    void orderMoves(Position &position, Moves &moves, const Move *first, int ply)
+    {
+        _scoreMoves(position, moves, _scores[ply], first ? *first : Move(), ply);
+    }
+
+    void pickMove(Moves &moves, int index, int ply) { _pickMove(moves, _scores[ply], index); }
+
+    // late quiet moves are rarely best, look at them shallower first and only search properly if they surprise
+    int reduction(Position &position, const Move &move, int depth, int index, bool pvNode, int ply)
+    {
+        if (depth < 3 || index < 3 || move.isCapture() || move.isPromotion() || _inCheck[ply] || position.inCheck()) {
+            return 0;
+        }
+        int reduction = _reductions[depth < SEARCH_MAX_PLY ? depth : SEARCH_MAX_PLY - 1][index < MAX_ORDERED ? index : MAX_ORDERED - 1];
+        if (pvNode && reduction > 0) reduction--;
+        if (reduction > depth - 2) reduction = depth - 2;
+        return reduction;
+    }
+
+    void onCutoff(Position &position, const Move &move, int depth, int ply)
+    {
+        if (!move.isCapture() && !move.isPromotion()) {
+            _rewardQuiet(position.sideToMove(), move, depth, ply);
+        }
+    }
+
+    // the table keeps the best line well enough, and chess orders the rest itself
+    static const bool FOLLOW_PV = false;
+
+    //
+    // chess's own
+    //
+
+    // piece type the move takes, pawns for en passant, 0 for none
+    static int _victim(const Position &position, const Move &move)
+    {
+        if (move.kind() == ChessMove::EN_PASSANT) {
+            return ChessPosition::PAWN;
+        }
+        return move.isCapture() ? ChessPosition::pieceType(position.pieceAt(move.to())) : 0;
+    }
+
+    void _scoreMoves(const Position &position, const typename Position::Moves &moves, int *scores, const Move &tableMove, int ply) const
+    {
+        int side = position.sideToMove();
+        for (int i = 0; i < moves.size(); i++) {
+            const Move &move = moves[i];
+            if (move == tableMove) {
+                scores[i] = TABLE_MOVE_SCORE;
+            } else if (move.isCapture() || move.isPromotion()) {
+                // most valuable victim first, cheapest attacker to break ties
+                int attacker = ChessPosition::pieceType(position.pieceAt(move.from()));
+                int promotion = move.isPromotion() ? move.promotion() * 8 : 0;
+                scores[i] = CAPTURE_SCORE + _victim(position, move) * 16 - attacker + promotion;
+            } else if (move == _killers[ply][0]) {
+                scores[i] = KILLER_SCORE + 1;
+            } else if (move == _killers[ply][1]) {
+                scores[i] = KILLER_SCORE;
+            } else {
+                scores[i] = _history[side][move.from()][move.to()];
+            }
+        }
+    }
+
+    // bring the best scored of the moves not yet tried to the front, cheaper than sorting when a cutoff comes early
+    static void _pickMove(typename Position::Moves &moves, int *scores, int index)
+    {
+        int best = index;
+        for (int i = index + 1; i < moves.size(); i++) {
+            if (scores[i] > scores[best]) {
+                best = i;
+            }
+        }
+        if (best != index) {
+            Move move = moves[index];
+            moves[index] = moves[best];
+            moves[best] = move;
+            int score = scores[index];
+            scores[index] = scores[best];
+            scores[best] = score;
+        }
+    }
+
+    void _rewardQuiet(int side, const Move &move, int depth, int ply)
+    {
+        if (!(move == _killers[ply][0])) {
+            _killers[ply][1] = _killers[ply][0];
+            _killers[ply][0] = move;
+        }
+        int &score = _history[side][move.from()][move.to()];
+        score += depth * depth;
+        if (score > HISTORY_LIMIT) {
+            _scaleHistory(2);
+        }
+    }
+
+    // divide every history score, 0 wipes them
+    void _scaleHistory(int divisor)
+    {
+        for (int side = 0; side < 2; side++) {
+            for (int from = 0; from < 64; from++) {
+                for (int to = 0; to < 64; to++) {
+                    int &score = _history[side][from][to];
+                    score = divisor ? score / divisor : 0;
+                }
+            }
+        }
+    }
+
+    //
+    // only captures and promotions from here on, so the score isn't taken halfway through an exchange
+    // the side to move can always stand pat instead, unless it's in check
+    //
+    int _quiesce(Position &position, int ply, int alpha, int beta)
+    {
+        _stats.nodes++;
+        _pvLength[ply] = 0;
+        if (_checkStop()) {
+            return 0;
+        }
+        if (ply >= SEARCH_MAX_PLY - 1) {
+            return position.eval();
+        }
+
+        bool inCheck = position.inCheck();
+        int standPat = -SEARCH_INFINITY;
+        typename Position::Moves moves;
+        if (inCheck) {
+            position.moves(moves);
+            if (moves.empty()) {
+                return -(SEARCH_WIN_SCORE - ply);
+            }
+        } else {
+            standPat = position.eval();
+            if (standPat >= beta) {
+                return standPat;
+            }
+            if (standPat > alpha) {
+                alpha = standPat;
+            }
+            position.captures(moves);
+        }
+        _stats.interiorNodes++;
+        int scores[Position::Moves::CAPACITY];
+        _scoreMoves(position, moves, scores, Move(), ply);
+
+        int best = standPat;
+        for (int i = 0; i < moves.size(); i++) {
+            _pickMove(moves, scores, i);
+            const Move move = moves[i];
+            if (!inCheck) {
+                // underpromotions only matter in studies
+                if (move.isPromotion() && move.promotion() != ChessPosition::QUEEN) {
+                    continue;
+                }
+                // even winning the piece for free wouldn't get back to alpha
+                static const int kGain[7] = { 0, 100, 320, 330, 500, 900, 0 };
+                if (!move.isPromotion() && standPat + kGain[_victim(position, move)] + 200 <= alpha) {
+                    continue;
+                }
+            }
+            _stats.movesSearched++;
+            position.play(move);
+            int score = -_quiesce(position, ply + 1, -beta, -alpha);
+            position.undo(move);
+            if (_stopped) {
+                return 0;
+            }
+            if (score > best) {
+                best = score;
+                if (score > alpha) {
+                    alpha = score;
+                    if (alpha >= beta) {
+                        _stats.cutoffs++;
+                        if (i == 0) {
+                            _stats.firstMoveCutoffs++;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+    bool            _inCheck[SEARCH_MAX_PLY] = {};    // set by extension() for each node on the way down
+    int             _staticEval[SEARCH_MAX_PLY] = {}; // set by prune() for the nodes it looks at
+    int             _window = 0;                      // the root's aspiration window either side of the last score
+    int             _scores[SEARCH_MAX_PLY][Moves::CAPACITY];
+    Move            _killers[SEARCH_MAX_PLY][2];
+    int             _history[2][64][64] = {};
+    uint8_t         _reductions[SEARCH_MAX_PLY][MAX_ORDERED] = {};
+};
+
+// anything playing by chess rules gets the chess search
+template <class Position>
+    requires std::derived_from<Position, ChessPosition>
+struct SearcherFor<Position>
+{
+    typedef ChessSearcher<Position> Type;
+};
@@ -0,0 +1,280 @@
+#include "Connect4Position.h"
+#include "BitOps.h"
+
+static const int kColumnBits = Connect4Position::HEIGHT + 1;
+static const uint64_t kBottomRow = 0x0040810204081ULL;  // bit 0 of every column
+static const uint64_t kBoardMask = kBottomRow * ((1ULL << Connect4Position::HEIGHT) - 1);
+static const int kMoveOrder[Connect4Position::WIDTH] = { 3, 2, 4, 1, 5, 0, 6 };
+
+static uint64_t cellBit(int column, int row)
+{
+    return 1ULL << (column * kColumnBits + row);
+}
+
+//
+// every line of four cells on the board, horizontal, vertical and both diagonals
+//
+struct Connect4Windows
+{
+    uint64_t masks[69];
+    int count;
+
+    Connect4Windows() : count(0)
+    {
+        const int directions[4][2] = { {1, 0}, {0, 1}, {1, 1}, {1, -1} };
+        for (const auto &direction : directions) {
+            for (int column = 0; column < Connect4Position::WIDTH; column++) {
+                for (int row = 0; row < Connect4Position::HEIGHT; row++) {
+                    int endColumn = column + direction[0] * 3;
+                    int endRow = row + direction[1] * 3;
+                    if (endColumn < 0 || endColumn >= Connect4Position::WIDTH || endRow < 0 || endRow >= Connect4Position::HEIGHT) {
+                        continue;
+                    }
+                    uint64_t mask = 0;
+                    for (int i = 0; i < 4; i++) {
+                        mask |= cellBit(column + direction[0] * i, row + direction[1] * i);
+                    }
+                    masks[count++] = mask;
+                }
+            }
+        }
+    }
+};
+
+static const Connect4Windows kWindows;
+
+Connect4Position::Connect4Position()
+{
+    reset();
+}
+
+void Connect4Position::reset()
+{
+    _pieces[0] = _pieces[1] = 0;
+    _mask = 0;
+    _plies = 0;
+    _winner = -1;
+}
+
+bool Connect4Position::hasFour(uint64_t pieces)
+{
+    // horizontal
+    uint64_t m = pieces & (pieces >> kColumnBits);
+    if (m & (m >> (2 * kColumnBits))) return true;
+    // diagonal down
+    m = pieces & (pieces >> (kColumnBits - 1));
+    if (m & (m >> (2 * (kColumnBits - 1)))) return true;
+    // diagonal up
+    m = pieces & (pieces >> (kColumnBits + 1));
+    if (m & (m >> (2 * (kColumnBits + 1)))) return true;
+    // vertical
+    m = pieces & (pieces >> 1);
+    if (m & (m >> 2)) return true;
+    return false;
+}
+
+//
+// empty cells that would finish a line of four for pieces, whether or not they can be played yet
+//
+static uint64_t winningCells(uint64_t pieces, uint64_t mask)
+{
+    // vertical, three stacked below the cell
+    uint64_t cells = (pieces << 1) & (pieces << 2) & (pieces << 3);
+    // horizontal and both diagonals, the gap can be at either end or in the middle
+    const int shifts[3] = { kColumnBits, kColumnBits - 1, kColumnBits + 1 };
+    for (int shift : shifts) {
+        uint64_t pair = (pieces << shift) & (pieces << (2 * shift));
+        cells |= pair & (pieces << (3 * shift));
+        cells |= pair & (pieces >> shift);
+        pair = (pieces >> shift) & (pieces >> (2 * shift));
+        cells |= pair & (pieces << shift);
+        cells |= pair & (pieces >> (3 * shift));
+    }
+    return cells & (kBoardMask ^ mask);
+}
+
+int Connect4Position::randomPlayout(uint64_t &seed) const
+{
+    if (gameOver()) {
+        return _winner;
+    }
+    uint64_t pieces[2] = { _pieces[0], _pieces[1] };
+    uint64_t mask = _mask;
+    int side = sideToMove();
+    while (true) {
+        // the lowest empty cell of every column that isn't full
+        uint64_t playable = (mask + kBottomRow) & kBoardMask;
+        if (!playable) {
+            return -1;
+        }
+        if (winningCells(pieces[side], mask) & playable) {
+            return side;
+        }
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        // no winning cell was playable, so whichever cell this is can't end the game
+        for (int skip = (int)(seed % (uint64_t)popCount(playable)); skip > 0; skip--) {
+            playable &= playable - 1;
+        }
+        uint64_t cell = playable & (0 - playable);
+        pieces[side] |= cell;
+        mask |= cell;
+        side ^= 1;
+    }
+}
+
+bool Connect4Position::canPlay(int column) const
+{
+    if (column < 0 || column >= WIDTH || gameOver()) {
+        return false;
+    }
+    return (_mask & cellBit(column, HEIGHT - 1)) == 0;
+}
+
+void Connect4Position::moves(Moves &list) const
+{
+    list.clear();
+    if (gameOver()) {
+        return;
+    }
+    for (int column : kMoveOrder) {
+        if ((_mask & cellBit(column, HEIGHT - 1)) == 0) {
+            list.push(column);
+        }
+    }
+}
+
+void Connect4Position::play(Move column)
+{
+    int side = sideToMove();
+    // adding the bottom cell to the column's mask carries up into the first empty cell
+    uint64_t newMask = _mask | (_mask + cellBit(column, 0));
+    _pieces[side] |= newMask ^ _mask;
+    _mask = newMask;
+    _plies++;
+    if (hasFour(_pieces[side])) {
+        _winner = side;
+    }
+}
+
+void Connect4Position::undo(Move column)
+{
+    _plies--;
+    int side = sideToMove();
+    // the top filled cell of the column is the one we played
+    uint64_t columnMask = _mask & (((1ULL << HEIGHT) - 1) << (column * kColumnBits));
+    uint64_t top = columnMask ^ ((columnMask >> 1) & columnMask);
+    _pieces[side] &= ~top;
+    _mask &= ~top;
+    _winner = -1;
+}
+
+int Connect4Position::eval() const
+{
+    static const int kLineScores[4] = { 0, 1, 10, 100 };
+    int side = sideToMove();
+    uint64_t mine = _pieces[side];
+    uint64_t theirs = _pieces[side ^ 1];
+    int score = 0;
+    for (int i = 0; i < kWindows.count; i++) {
+        uint64_t window = kWindows.masks[i];
+        int myCount = popCount(window & mine);
+        int theirCount = popCount(window & theirs);
+        // a line both players have a piece in can never be won
+        if (theirCount == 0) {
+            score += kLineScores[myCount < 4 ? myCount : 3];
+        } else if (myCount == 0) {
+            score -= kLineScores[theirCount < 4 ? theirCount : 3];
+        }
+    }
+    return score;
+}
+
+uint64_t Connect4Position::hash() const
+{
+    // mask plus the side to move's stones is a unique key, mix it so table indexes spread out
+    return mixHash(_pieces[sideToMove()] + _mask + kBottomRow);
+}
+
+int Connect4Position::pieceAt(int column, int row) const
+{
+    uint64_t bit = cellBit(column, row);
+    if (_pieces[0] & bit) return 0;
+    if (_pieces[1] & bit) return 1;
+    return -1;
+}
+
+int Connect4Position::landingRow(int column) const
+{
+    if (column < 0 || column >= WIDTH) {
+        return -1;
+    }
+    for (int row = 0; row < HEIGHT; row++) {
+        if ((_mask & cellBit(column, row)) == 0) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+std::string Connect4Position::stateString() const
+{
+    std::string state;
+    state.reserve(WIDTH * HEIGHT);
+    for (int row = HEIGHT - 1; row >= 0; row--) {
+        for (int column = 0; column < WIDTH; column++) {
+            state += (char)('1' + pieceAt(column, row));
+        }
+    }
+    return state;
+}
+
+bool Connect4Position::setStateString(const std::string &s)
+{
+    if (s.length() != WIDTH * HEIGHT) {
+        return false;
+    }
+    uint64_t pieces[2] = { 0, 0 };
+    int counts[2] = { 0, 0 };
+    for (int column = 0; column < WIDTH; column++) {
+        bool emptyBelow = false;
+        for (int row = 0; row < HEIGHT; row++) {
+            char c = s[(HEIGHT - 1 - row) * WIDTH + column];
+            if (c == '0') {
+                emptyBelow = true;
+                continue;
+            }
+            // no floating pieces
+            if ((c != '1' && c != '2') || emptyBelow) {
+                return false;
+            }
+            int player = c - '1';
+            pieces[player] |= cellBit(column, row);
+            counts[player]++;
+        }
+    }
+    if (counts[0] != counts[1] && counts[0] != counts[1] + 1) {
+        return false;
+    }
+    _pieces[0] = pieces[0];
+    _pieces[1] = pieces[1];
+    _mask = pieces[0] | pieces[1];
+    _plies = counts[0] + counts[1];
+    _winner = hasFour(pieces[0]) ? 0 : (hasFour(pieces[1]) ? 1 : -1);
+    return true;
+}
+
+std::string Connect4Position::moveToString(Move column) const
+{
+    return std::string(1, (char)('1' + column));
+}
+
+bool Connect4Position::parseMove(const std::string &text, Move &column) const
+{
+    if (text.length() != 1 || text[0] < '1' || text[0] >= '1' + WIDTH) {
+        return false;
+    }
+    column = text[0] - '1';
+    return canPlay(column);
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "MoveList.h"
+#include <cstdint>
+#include <string>
+
+//
+// connect 4 rules on bitboards, no rendering
+// each column takes 7 bits (6 rows plus a sentinel), bit = column * 7 + row with row 0 at the bottom
+// player 0 moves first
+//
+class Connect4Position
+{
+public:
+    static const int WIDTH = 7;
+    static const int HEIGHT = 6;
+
+    typedef int Move;   // the column to drop into
+    typedef MoveList<Move, WIDTH> Moves;
+
+    Connect4Position();
+
+    void        reset();
+
+    // legal moves, centre columns first since they are usually best
+    void        moves(Moves &list) const;
+    bool        canPlay(int column) const;
+    void        play(Move column);
+    void        undo(Move column);
+
+    int         sideToMove() const { return _plies & 1; }
+    int         plies() const { return _plies; }
+    bool        gameOver() const { return _winner >= 0 || _plies == WIDTH * HEIGHT; }
+    // player who connected four, -1 if nobody has
+    int         winner() const { return _winner; }
+    // heuristic score from the side to move's point of view
+    int         eval() const;
+    uint64_t    hash() const;
+
+    // -1 for an empty cell, otherwise the player number
+    int         pieceAt(int column, int row) const;
+    // row a piece dropped in column lands on, -1 if the column is full
+    int         landingRow(int column) const;
+    uint64_t    pieces(int player) const { return _pieces[player]; }
+
+    // '0' empty, '1' player 0, '2' player 1, top row first, same layout as the game window
+    std::string stateString() const;
+    bool        setStateString(const std::string &s);
+
+    // columns are written 1 to 7
+    std::string moveToString(Move column) const;
+    bool        parseMove(const std::string &text, Move &column) const;
+
+    // plays random moves on a copy of the bitboards until the game ends, taking a win whenever one is there
+    // returns the winner or -1 for a draw, seed is a xorshift state that is never 0
+    int         randomPlayout(uint64_t &seed) const;
+
+    static bool hasFour(uint64_t pieces);
+
+private:
+    uint64_t    _pieces[2];
+    uint64_t    _mask;
+    int         _plies;
+    int         _winner;
+};
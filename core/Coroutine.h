@@ -0,0 +1,143 @@
+#pragma once
+#include <coroutine>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <vector>
+
+//
+// coroutines that call each other like functions make and free their frames in stack order,
+// so freed frames are kept by size and handed straight back out instead of going to malloc
+// one pool per thread, nothing is shared
+//
+class CoroutineFrames
+{
+public:
+    static const size_t GRANULE = 64;
+    static const size_t CLASSES = 64;   // frames up to 4k are pooled, bigger ones use malloc
+
+    static void *allocate(size_t bytes)
+    {
+        size_t index = (bytes + GRANULE - 1) / GRANULE;
+        if (index < CLASSES) {
+            std::vector<void *> &free = _pool().free[index];
+            if (!free.empty()) {
+                void *frame = free.back();
+                free.pop_back();
+                return frame;
+            }
+            return malloc(index * GRANULE);
+        }
+        return malloc(bytes);
+    }
+
+    static void release(void *frame, size_t bytes)
+    {
+        size_t index = (bytes + GRANULE - 1) / GRANULE;
+        if (index < CLASSES) {
+            _pool().free[index].push_back(frame);
+        } else {
+            free(frame);
+        }
+    }
+
+private:
+    struct Pool
+    {
+        std::vector<void *> free[CLASSES];
+
+        ~Pool()
+        {
+            for (std::vector<void *> &frames : free) {
+                for (void *frame : frames) {
+                    ::free(frame);
+                }
+            }
+        }
+    };
+
+    static Pool &_pool()
+    {
+        static thread_local Pool pool;
+        return pool;
+    }
+};
+
+//
+// a coroutine returning T, it doesn't run until something awaits it or resumes it
+// awaiting one runs it straight away and carries on with its value when it returns,
+// so a recursive search written with co_await can stop anywhere inside and pick up there later
+//
+template <class T>
+class Task
+{
+public:
+    struct promise_type
+    {
+        T                       value{};
+        std::coroutine_handle<> continuation;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        // straight back into whoever awaited, or out to whoever resumed if nobody did
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+            {
+                std::coroutine_handle<> continuation = handle.promise().continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_value(const T &result) { value = result; }
+        void unhandled_exception() { std::terminate(); }
+
+        static void *operator new(size_t bytes) { return CoroutineFrames::allocate(bytes); }
+        static void operator delete(void *frame, size_t bytes) { CoroutineFrames::release(frame, bytes); }
+    };
+
+    Task() {}
+    Task(Task &&other) noexcept : _handle(other._handle) { other._handle = nullptr; }
+    Task &operator=(Task &&other) noexcept
+    {
+        if (this != &other) {
+            if (_handle) {
+                _handle.destroy();
+            }
+            _handle = other._handle;
+            other._handle = nullptr;
+        }
+        return *this;
+    }
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    ~Task()
+    {
+        if (_handle) {
+            _handle.destroy();
+        }
+    }
+
+    bool await_ready() const { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting)
+    {
+        _handle.promise().continuation = awaiting;
+        return _handle;
+    }
+    T await_resume() const { return _handle.promise().value; }
+
+    // for whoever drives the outermost task
+    explicit operator bool() const { return (bool)_handle; }
+    std::coroutine_handle<> handle() const { return _handle; }
+    bool done() const { return !_handle || _handle.done(); }
+    const T &value() const { return _handle.promise().value; }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+
+    std::coroutine_handle<promise_type> _handle;
+};
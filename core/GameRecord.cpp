@@ -0,0 +1,291 @@
+#include "GameRecord.h"
+#include <cstring>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char kMagic[4] = { 'M', 'C', '4', 'R' };
+static const uint32_t kVersion = 1;
+static const size_t kFileHeaderBytes = 8;
+static const size_t kGameHeaderBytes = 16;
+
+static const char *kTitleNames[RECORD_TITLES] = { "connect4", "othello", "checkers", "tictactoe", "chess" };
+
+const char *gameRecordTitleName(GameRecordTitle title)
+{
+    return title < RECORD_TITLES ? kTitleNames[title] : "unknown";
+}
+
+bool gameRecordTitleFromName(const std::string &name, GameRecordTitle &title)
+{
+    for (int i = 0; i < RECORD_TITLES; i++) {
+        if (name == kTitleNames[i]) {
+            title = (GameRecordTitle)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// byte by byte so the file reads the same on any machine, and nothing has to be aligned
+static void put16(std::vector<uint8_t> &out, uint16_t value)
+{
+    out.push_back((uint8_t)value);
+    out.push_back((uint8_t)(value >> 8));
+}
+
+static uint16_t get16(const uint8_t *at)
+{
+    return (uint16_t)(at[0] | at[1] << 8);
+}
+
+static void put64(std::vector<uint8_t> &out, uint64_t value)
+{
+    for (int i = 0; i < 8; i++) {
+        out.push_back((uint8_t)(value >> (8 * i)));
+    }
+}
+
+static uint64_t get64(const uint8_t *at)
+{
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = value << 8 | at[i];
+    }
+    return value;
+}
+
+//
+// writer
+//
+
+bool GameRecordWriter::open(const std::string &path)
+{
+    close();
+    FILE *file = fopen(path.c_str(), "ab");
+    if (!file) {
+        return false;
+    }
+    // appending puts the position at the end, anything there already is an earlier session's games
+    fseek(file, 0, SEEK_END);
+    if (ftell(file) == 0) {
+        uint8_t header[kFileHeaderBytes];
+        memcpy(header, kMagic, 4);
+        for (int i = 0; i < 4; i++) {
+            header[4 + i] = (uint8_t)(kVersion >> (8 * i));
+        }
+        if (fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+            fclose(file);
+            return false;
+        }
+    }
+    _file = file;
+    _failed = false;
+    _games = 0;
+    return true;
+}
+
+void GameRecordWriter::close()
+{
+    flush();
+    if (_file) {
+        fclose(_file);
+        _file = nullptr;
+    }
+}
+
+void GameRecordWriter::record(const GameRecord &game)
+{
+    // no state string comes anywhere near the limit, one that does isn't a real position
+    if (!_file || game.start.size() > 0xffff) {
+        return;
+    }
+    // a game too long for the count is cut short and called unfinished, no real game gets near it either
+    size_t moveCount = game.moves.size() < 0xffff ? game.moves.size() : 0xffff;
+    size_t startBytes = game.start.size();
+    GameRecordResult result = moveCount == game.moves.size() ? game.result : RESULT_UNFINISHED;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _pending.push_back(game.title);
+    _pending.push_back(result);
+    put16(_pending, (uint16_t)moveCount);
+    put16(_pending, (uint16_t)startBytes);
+    _pending.push_back(startBytes > 0 && game.startSide >= 0 ? (uint8_t)(game.startSide + 1) : 0);
+    _pending.push_back(0);
+    put64(_pending, game.time);
+    _pending.insert(_pending.end(), game.start.begin(), game.start.begin() + startBytes);
+    for (size_t i = 0; i < moveCount; i++) {
+        put16(_pending, game.moves[i]);
+    }
+    _games++;
+    if (!_writing) {
+        _writing = true;
+        _task = Scheduler::shared().submit([this](const std::atomic<bool> &stop) { return _drain(); },
+                                           Scheduler::BACKGROUND, "record games");
+    }
+}
+
+void GameRecordWriter::flush()
+{
+    while (true) {
+        TaskHandle task;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_writing) {
+                return;
+            }
+            task = _task;
+        }
+        task.wait();
+    }
+}
+
+//
+// writes the buffer out until nothing more has come in, the buffer is swapped out so record() never waits on the disk
+//
+bool GameRecordWriter::_drain()
+{
+    std::vector<uint8_t> writing;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            writing.clear();
+            writing.swap(_pending);
+            if (writing.empty()) {
+                _writing = false;
+                return true;
+            }
+        }
+        if (fwrite(writing.data(), 1, writing.size(), _file) != writing.size() || fflush(_file) != 0) {
+            _failed = true;
+        }
+    }
+}
+
+//
+// reader
+//
+
+GameRecord GameRecordView::copy() const
+{
+    GameRecord game;
+    game.title = title;
+    game.result = result;
+    game.time = time;
+    game.start = std::string(start);
+    game.startSide = startSide;
+    game.moves.resize(moveCount);
+    for (int i = 0; i < moveCount; i++) {
+        game.moves[i] = move(i);
+    }
+    return game;
+}
+
+bool GameRecordFile::open(const std::string &path)
+{
+    close();
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    const void *data = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart >= (LONGLONG)kFileHeaderBytes) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    }
+    if (!data) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    _fileHandle = file;
+    _mapping = mapping;
+    _data = static_cast<const uint8_t *>(data);
+    _size = (size_t)size.QuadPart;
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat info;
+    void *data = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size >= (off_t)kFileHeaderBytes) {
+        data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    // the mapping keeps the file alive on its own
+    ::close(file);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    // read front to back, the kernel can read well ahead and drop pages once they're passed
+    madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+    _data = static_cast<const uint8_t *>(data);
+    _size = (size_t)info.st_size;
+#endif
+    if (memcmp(_data, kMagic, 4) != 0 || (uint32_t)(_data[4] | _data[5] << 8 | _data[6] << 16 | (uint32_t)_data[7] << 24) != kVersion) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void GameRecordFile::close()
+{
+    if (!_data) {
+        return;
+    }
+#if defined(_WIN32)
+    UnmapViewOfFile(_data);
+    CloseHandle((HANDLE)_mapping);
+    CloseHandle((HANDLE)_fileHandle);
+    _mapping = nullptr;
+    _fileHandle = nullptr;
+#else
+    munmap(const_cast<uint8_t *>(_data), _size);
+#endif
+    _data = nullptr;
+    _size = 0;
+}
+
+GameRecordFile::Iterator GameRecordFile::begin() const
+{
+    return _data ? Iterator(_data + kFileHeaderBytes, _data + _size) : end();
+}
+
+GameRecordFile::Iterator GameRecordFile::end() const
+{
+    return Iterator(_data + _size, _data + _size);
+}
+
+void GameRecordFile::Iterator::_read(const uint8_t *at)
+{
+    _at = _end;
+    if (!at || (size_t)(_end - at) < kGameHeaderBytes) {
+        return;
+    }
+    int moveCount = get16(at + 2);
+    int startBytes = get16(at + 4);
+    size_t bytes = kGameHeaderBytes + startBytes + 2 * (size_t)moveCount;
+    if ((size_t)(_end - at) < bytes) {
+        return;
+    }
+    _game.title = (GameRecordTitle)at[0];
+    _game.result = (GameRecordResult)at[1];
+    _game.moveCount = moveCount;
+    _game.startSide = at[6] - 1;
+    _game.time = get64(at + 8);
+    _game.start = std::string_view(reinterpret_cast<const char *>(at + kGameHeaderBytes), startBytes);
+    _game.moveData = at + kGameHeaderBytes + startBytes;
+    _at = at;
+    _next = at + bytes;
+}
@@ -0,0 +1,200 @@
+#pragma once
+#include "Scheduler.h"
+#include "Search.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//
+// a compact binary file of finished games, every title's games can go in the same file
+// the file starts with "MC4R" and a 32 bit version, then the games one after another, each of them
+//   uint8   title      GameRecordTitle
+//   uint8   result     GameRecordResult
+//   uint16  moves      how many moves
+//   uint16  start      bytes of start state, 0 when the game began from the title's usual start position
+//   uint8   side       who moves first from the start state plus one, 0 with the usual start,
+//                      some titles' state strings don't say
+//   uint8   reserved
+//   uint64  time       when the game finished, seconds since 1970
+//   the start position's stateString(), then each move's 16 bit moveCode()
+// all little endian, a game is 16 bytes plus two a move, so even a long chess game is a few hundred bytes
+// games only ever get appended, a file cut short by a crash just loses the game that was being written
+//
+enum GameRecordTitle : uint8_t { RECORD_CONNECT4, RECORD_OTHELLO, RECORD_CHECKERS, RECORD_TICTACTOE, RECORD_CHESS, RECORD_TITLES };
+// players are numbered by who moves first from the usual start
+enum GameRecordResult : uint8_t { RESULT_UNFINISHED, RESULT_PLAYER1, RESULT_PLAYER2, RESULT_DRAW };
+
+// "connect4", "othello", "checkers", "tictactoe" and "chess", the names the command line tools take
+const char *gameRecordTitleName(GameRecordTitle title);
+bool gameRecordTitleFromName(const std::string &name, GameRecordTitle &title);
+
+struct GameRecord
+{
+    GameRecordTitle         title = RECORD_CONNECT4;
+    GameRecordResult        result = RESULT_UNFINISHED;
+    uint64_t                time = 0;
+    std::string             start;          // empty for the usual start position
+    int                     startSide = -1; // the side to move in start, -1 with the usual start
+    std::vector<uint16_t>   moves;
+};
+
+// how a core position's game ended, winner() is the side that won or -1
+template <class Position>
+GameRecordResult gameRecordResult(const Position &position)
+{
+    if (!position.gameOver()) {
+        return RESULT_UNFINISHED;
+    }
+    int winner = position.winner();
+    return winner < 0 ? RESULT_DRAW : (winner == 0 ? RESULT_PLAYER1 : RESULT_PLAYER2);
+}
+
+//
+// appends games to a record file without making whoever finished the game wait for the disk
+// record() only packs the game into a buffer, a background task on the shared scheduler writes the buffer out,
+// games finished while it's busy are picked up by the same task
+//
+class GameRecordWriter
+{
+public:
+    GameRecordWriter() {}
+    ~GameRecordWriter() { close(); }
+    GameRecordWriter(const GameRecordWriter &) = delete;
+    GameRecordWriter &operator=(const GameRecordWriter &) = delete;
+
+    // appends to path, starting it with the header if it's new, false if it can't be written
+    bool        open(const std::string &path);
+    // writes whatever is still queued first
+    void        close();
+    bool        isOpen() const { return _file != nullptr; }
+    // true once a write has failed, the games since then are lost
+    bool        failed() const { return _failed; }
+    // games handed to record() since open()
+    uint64_t    games() const { return _games; }
+
+    // safe from any thread, ignored while the writer isn't open
+    void        record(const GameRecord &game);
+    // wait for every game recorded so far to be written
+    void        flush();
+
+private:
+    bool        _drain();
+
+    FILE                    *_file = nullptr;
+    std::mutex              _mutex;
+    std::vector<uint8_t>    _pending;
+    bool                    _writing = false;   // a drain task is queued or running
+    TaskHandle              _task;
+    std::atomic<bool>       _failed{ false };
+    std::atomic<uint64_t>   _games{ 0 };
+};
+
+//
+// one game as it sits in a mapped record file, nothing is copied, it's only valid while the file is open
+//
+struct GameRecordView
+{
+    GameRecordTitle     title;
+    GameRecordResult    result;
+    uint64_t            time;
+    std::string_view    start;          // empty for the usual start position
+    int                 startSide;      // -1 with the usual start
+    int                 moveCount;
+    const uint8_t       *moveData;
+
+    uint16_t move(int index) const { return (uint16_t)(moveData[2 * index] | moveData[2 * index + 1] << 8); }
+    GameRecord copy() const;
+};
+
+//
+// a record file mapped into memory, games are read straight out of the mapping in the order they were written,
+//   for (const GameRecordView &game : file) ...
+// the system pages the file in as the loop gets to it, so millions of games cost no more memory than a few
+//
+class GameRecordFile
+{
+public:
+    GameRecordFile() {}
+    ~GameRecordFile() { close(); }
+    GameRecordFile(const GameRecordFile &) = delete;
+    GameRecordFile &operator=(const GameRecordFile &) = delete;
+
+    // false if path can't be mapped or isn't a record file
+    bool        open(const std::string &path);
+    void        close();
+    size_t      bytes() const { return _size; }
+
+    class Iterator
+    {
+    public:
+        const GameRecordView &operator*() const { return _game; }
+        const GameRecordView *operator->() const { return &_game; }
+        Iterator &operator++() { _read(_next); return *this; }
+        bool operator==(const Iterator &other) const { return _at == other._at; }
+        bool operator!=(const Iterator &other) const { return _at != other._at; }
+
+    private:
+        friend class GameRecordFile;
+        Iterator(const uint8_t *at, const uint8_t *end) : _end(end) { _read(at); }
+
+        // reads the game at at, a game running past the end of the file is the end
+        void _read(const uint8_t *at);
+
+        const uint8_t   *_at = nullptr;
+        const uint8_t   *_next = nullptr;
+        const uint8_t   *_end = nullptr;
+        GameRecordView  _game{};
+    };
+
+    Iterator    begin() const;
+    Iterator    end() const;
+
+private:
+    const uint8_t   *_data = nullptr;
+    size_t          _size = 0;
+#if defined(_WIN32)
+    void            *_fileHandle = nullptr;
+    void            *_mapping = nullptr;
+#endif
+};
+
+//
+// plays a recorded game through on position, visit(position, move) is called before each move is played
+// codes are matched back to the position's own moves like the search table does, false if the start doesn't
+// parse or a code matches no legal move, position is left where the game got to
+//
+template <class Position, class Visit>
+bool replayGameRecord(const GameRecordView &game, Position &position, Visit visit)
+{
+    position = Position();
+    if (!game.start.empty() && !position.setStateString(std::string(game.start))) {
+        return false;
+    }
+    if (game.startSide >= 0) {
+        if constexpr (requires(Position p) { p.setSideToMove(0); }) {
+            position.setSideToMove(game.startSide);
+        }
+    }
+    for (int i = 0; i < game.moveCount; i++) {
+        uint16_t code = game.move(i);
+        typename Position::Moves moves;
+        position.moves(moves);
+        int found = -1;
+        for (int j = 0; j < moves.size() && found < 0; j++) {
+            if (moveCode(moves[j]) == code) {
+                found = j;
+            }
+        }
+        if (found < 0) {
+            return false;
+        }
+        typename Position::Move move = moves[found];
+        visit(position, move);
+        position.play(move);
+    }
+    return true;
+}
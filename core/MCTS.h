@@ -0,0 +1,512 @@
+#pragma once
+#include "Arena.h"
+#include "SearchStats.h"
+#include "Scheduler.h"
+#include "Trace.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//
+// monte carlo tree search with UCT selection, no evaluation function, just random games to the end
+// works on any core position with Move, Moves, moves(), play(), undo(), gameOver(), winner(), sideToMove(), hash() and moveToString()
+// positions that have randomPlayout(seed) finish their games on their own bitboards, anything else plays random moves()
+//
+struct MctsLimits
+{
+    int64_t                 movetime = 0;       // milliseconds, 0 for no limit
+    uint64_t                playouts = 0;       // new playouts to run, 0 for no limit
+    uint64_t                rootPlayouts = 0;   // stop once the root has this many, counting ones reused from earlier moves
+    const std::atomic<bool> *stop = nullptr;    // set from another thread to stop early
+};
+
+template <class Position>
+struct MctsResult
+{
+    typename Position::Move bestMove{};
+    bool        found = false;      // false when there was nothing to play
+    double      winRate = 0.0;      // how often the side to move won the playouts through bestMove
+    uint64_t    playouts = 0;       // run by this search
+    uint64_t    reusedPlayouts = 0; // already under the root from earlier moves
+    uint64_t    treeNodes = 0;
+    int64_t     milliseconds = 0;
+
+    double playoutsPerSecond() const { return milliseconds > 0 ? playouts * 1000.0 / milliseconds : 0.0; }
+};
+
+//
+// the tree lives in arenas that are thrown away every move
+// whatever is still reachable after the moves played since the last search is copied into a fresh arena first,
+// so the playouts spent on the reply that actually came carry over
+//
+// with more than one thread the work is split one of two ways
+//   TREE_PARALLEL  every thread walks the same tree, counts are atomic and a thread passing through a node
+//                  counts its visit straight away, so until its result comes back the node looks like a loss
+//                  and the others spread out to other lines (virtual loss)
+//   ROOT_PARALLEL  every thread grows a tree of its own and the root moves' counts are added up at the end,
+//                  nothing is shared while searching
+//
+template <class Position>
+class Mcts
+{
+public:
+    typedef typename Position::Move Move;
+    typedef MctsResult<Position> Result;
+
+    enum Parallelism { TREE_PARALLEL, ROOT_PARALLEL };
+
+    static constexpr double DEFAULT_EXPLORATION = 1.41;
+    // a leaf is only given children once this many playouts have gone through it, keeps the tree to about one node a playout
+    static const uint32_t DEFAULT_EXPAND_VISITS = 8;
+    // past this the tree stops growing and playouts just start from the leaves it has
+    static const size_t DEFAULT_TREE_BYTES = 256 << 20;
+
+    Mcts(double exploration = DEFAULT_EXPLORATION) : _exploration(exploration) { setThreads(1); }
+
+    void setExploration(double exploration) { _exploration = exploration; }
+    void setExpandVisits(uint32_t visits) { _expandVisits = visits; }
+    void setTreeBytes(size_t bytes) { _treeBytes = bytes; }
+
+    // trees are laid out per thread, changing either throws the current one away
+    void setThreads(int threads)
+    {
+        threads = threads > 0 ? threads : 1;
+        _workers.clear();
+        for (int i = 0; i < threads; i++) {
+            _workers.push_back(std::make_unique<Worker>());
+            // each thread plays different random games
+            _workers.back()->seed = 0x9e3779b97f4a7c15ULL * (i + 1);
+        }
+        reset();
+    }
+    int threads() const { return (int)_workers.size(); }
+
+    void setParallelism(Parallelism parallelism)
+    {
+        if (parallelism != _parallelism) {
+            _parallelism = parallelism;
+            reset();
+        }
+    }
+    Parallelism parallelism() const { return _parallelism; }
+
+    // forget the tree, the next search starts from nothing
+    void reset()
+    {
+        for (auto &worker : _workers) {
+            worker->root = nullptr;
+            worker->arenas[0].reset();
+            worker->arenas[1].reset();
+            worker->nodes = 0;
+        }
+    }
+
+    // numbers from the last search, playouts stand in for nodes
+    const SearchStats &stats() const { return _stats; }
+
+    Result search(const Position &position, const MctsLimits &limits)
+    {
+        TraceScope searchScope("mcts", "search", "threads", (int64_t)_workers.size());
+        _start = std::chrono::steady_clock::now();
+        _stats.reset();
+
+        Result result;
+        result.reusedPlayouts = _reroot(position);
+        for (auto &worker : _workers) {
+            if (worker->root->state.load(std::memory_order_relaxed) != EXPANDED) {
+                _expand(*worker, *worker->root);
+            }
+        }
+        Worker &main = *_workers[0];
+        if (main.root->childCount == 0) {
+            return result;
+        }
+        result.found = true;
+
+        _limits = limits;
+        if (limits.rootPlayouts > 0) {
+            // a tree grown while pondering may already be big enough, one more playout and it's done
+            uint64_t left = limits.rootPlayouts > result.reusedPlayouts ? limits.rootPlayouts - result.reusedPlayouts : 1;
+            if (_limits.playouts == 0 || left < _limits.playouts) {
+                _limits.playouts = left;
+            }
+        }
+        _stopped = false;
+        _playouts = 0;
+        // helpers are scheduler tasks, one that only starts after the main worker is done finds the search stopped
+        // and returns, so asking for more trees than there are free cores costs nothing
+        std::vector<TaskHandle> helpers;
+        for (size_t i = 1; i < _workers.size(); i++) {
+            helpers.push_back(Scheduler::shared().submit([this, i](const std::atomic<bool> &stop) {
+                _run(*_workers[i], &stop);
+                return true;
+            }, Scheduler::currentPriority(), "mcts"));
+        }
+        _run(main, nullptr);
+        _stopped = true;
+        for (TaskHandle &helper : helpers) {
+            helper.wait();
+        }
+
+        // root parallel trees only meet here, a move's counts are the sum over every tree
+        std::vector<uint64_t> visits(main.root->childCount, 0);
+        std::vector<uint64_t> scores(main.root->childCount, 0);
+        result.treeNodes = 0;
+        _stats.depth = 0;
+        for (auto &worker : _workers) {
+            result.treeNodes += worker->nodes;
+            _stats.depth = worker->maxDepth > _stats.depth ? worker->maxDepth : _stats.depth;
+            if (_parallelism == TREE_PARALLEL && worker.get() != &main) {
+                continue;
+            }
+            const Node *root = worker->root;
+            for (int i = 0; i < root->childCount && i < main.root->childCount; i++) {
+                visits[i] += root->children[i].visits.load(std::memory_order_relaxed);
+                scores[i] += root->children[i].score.load(std::memory_order_relaxed);
+            }
+        }
+        int best = 0;
+        for (int i = 1; i < main.root->childCount; i++) {
+            if (visits[i] > visits[best]) {
+                best = i;
+            }
+        }
+        result.bestMove = main.root->children[best].move;
+        result.winRate = visits[best] ? scores[best] / (2.0 * visits[best]) : 0.0;
+        result.playouts = _playouts.load();
+        _stats.microseconds = _elapsedMicroseconds();
+        result.milliseconds = _stats.microseconds / 1000;
+
+        _stats.nodes = result.playouts;
+        _stats.playouts = result.playouts;
+        _stats.reusedPlayouts = result.reusedPlayouts;
+        _stats.treeNodes = result.treeNodes;
+        _stats.score = (int)(result.winRate * 100.0 + 0.5);
+        _stats.pv = _pvString(main, best);
+        return result;
+    }
+
+private:
+    enum State : uint8_t { LEAF, EXPANDING, EXPANDED };
+
+    struct Node
+    {
+        Move        move{};
+        // visits are counted on the way down, score when the playout comes back
+        std::atomic<uint32_t> visits{0};
+        std::atomic<uint32_t> score{0};     // twice the wins for the player who played move, a draw scores 1
+        std::atomic<uint8_t>  state{LEAF};  // children and childCount may only be read once this is EXPANDED
+        uint16_t    childCount = 0;
+        Node        *children = nullptr;
+    };
+
+    // everything one thread touches while searching, its own arenas included so growing the tree never takes a lock
+    struct Worker
+    {
+        Arena       arenas[2];
+        Node        *root = nullptr;    // shared by every worker in tree parallel mode
+        Position    position;           // the root position, back there between playouts
+        uint64_t    seed = 0;
+        uint64_t    nodes = 0;          // allocated from this worker's arenas
+        int         maxDepth = 0;
+        std::vector<Node *> path;
+        std::vector<int> movers;
+        std::vector<Move> rolloutMoves;
+    };
+
+    int64_t _elapsedMicroseconds() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start).count();
+    }
+
+    // taskStop is a helper's own stop flag, raised when the scheduler shuts down or the task is preempted
+    void _run(Worker &worker, const std::atomic<bool> *taskStop)
+    {
+        worker.maxDepth = 0;
+        uint64_t playouts = 0;
+        while (!_stopped.load(std::memory_order_relaxed) && !(taskStop && taskStop->load(std::memory_order_relaxed))) {
+            // a playout is a few microseconds, the clock only needs looking at now and then
+            if ((playouts & 63) == 0 && playouts > 0) {
+                if ((_limits.stop && _limits.stop->load(std::memory_order_relaxed)) ||
+                    (_limits.movetime > 0 && _elapsedMicroseconds() >= _limits.movetime * 1000)) {
+                    _stopped = true;
+                    break;
+                }
+            }
+            if (_limits.playouts > 0 && _playouts.fetch_add(1, std::memory_order_relaxed) >= _limits.playouts) {
+                _playouts.fetch_sub(1, std::memory_order_relaxed);
+                _stopped = true;
+                break;
+            }
+            _playout(worker);
+            playouts++;
+        }
+        if (_limits.playouts == 0) {
+            _playouts.fetch_add(playouts, std::memory_order_relaxed);
+        }
+    }
+
+    // gives node its children, false if another thread got there first or the tree is already as big as it may get
+    bool _expand(Worker &worker, Node &node)
+    {
+        if (worker.arenas[_current].used() >= _treeBytes / _workers.size() && !worker.position.gameOver()) {
+            return false;
+        }
+        uint8_t expected = LEAF;
+        if (!node.state.compare_exchange_strong(expected, EXPANDING, std::memory_order_acquire)) {
+            return false;
+        }
+        if (!worker.position.gameOver()) {
+            typename Position::Moves moves;
+            worker.position.moves(moves);
+            Node *children = worker.arenas[_current].template allocateArray<Node>(moves.size());
+            if (!children) {
+                node.state.store(LEAF, std::memory_order_release);
+                return false;
+            }
+            for (int i = 0; i < moves.size(); i++) {
+                children[i].move = moves[i];
+            }
+            node.children = children;
+            node.childCount = (uint16_t)moves.size();
+            worker.nodes += moves.size();
+        }
+        node.state.store(EXPANDED, std::memory_order_release);
+        return true;
+    }
+
+    // children nobody has tried go first, in move order, then the best upper confidence bound
+    Node *_select(Node &parent) const
+    {
+        double logVisits = std::log((double)parent.visits.load(std::memory_order_relaxed));
+        Node *best = &parent.children[0];
+        double bestScore = -1.0;
+        for (int i = 0; i < parent.childCount; i++) {
+            Node &child = parent.children[i];
+            uint32_t visits = child.visits.load(std::memory_order_relaxed);
+            if (visits == 0) {
+                return &child;
+            }
+            double wins = child.score.load(std::memory_order_relaxed) * 0.5;
+            double score = wins / visits + _exploration * std::sqrt(logVisits / visits);
+            if (score > bestScore) {
+                bestScore = score;
+                best = &child;
+            }
+        }
+        return best;
+    }
+
+    // down the tree to a leaf, a random game from there, and the result back up the path
+    void _playout(Worker &worker)
+    {
+        Node *node = worker.root;
+        worker.path.clear();
+        worker.movers.clear();
+        worker.path.push_back(node);
+        worker.movers.push_back(-1);
+        node->visits.fetch_add(1, std::memory_order_relaxed);
+        while (true) {
+            if (node->state.load(std::memory_order_acquire) != EXPANDED &&
+                (node->visits.load(std::memory_order_relaxed) <= _expandVisits || !_expand(worker, *node))) {
+                break;
+            }
+            if (node->childCount == 0) {
+                break;
+            }
+            node = _select(*node);
+            node->visits.fetch_add(1, std::memory_order_relaxed);
+            worker.movers.push_back(worker.position.sideToMove());
+            worker.position.play(node->move);
+            worker.path.push_back(node);
+        }
+        if ((int)worker.path.size() - 1 > worker.maxDepth) {
+            worker.maxDepth = (int)worker.path.size() - 1;
+        }
+
+        int winner = _rollout(worker);
+        for (size_t i = 0; i < worker.path.size(); i++) {
+            if (winner < 0) {
+                worker.path[i]->score.fetch_add(1, std::memory_order_relaxed);
+            } else if (winner == worker.movers[i]) {
+                worker.path[i]->score.fetch_add(2, std::memory_order_relaxed);
+            }
+        }
+        for (size_t i = worker.path.size() - 1; i > 0; i--) {
+            worker.position.undo(worker.path[i]->move);
+        }
+    }
+
+    static int _rollout(Worker &worker)
+    {
+        if constexpr (requires(const Position &p, uint64_t &seed) { p.randomPlayout(seed); }) {
+            return worker.position.randomPlayout(worker.seed);
+        } else {
+            int plies = 0;
+            typename Position::Moves moves;
+            worker.rolloutMoves.clear();
+            while (!worker.position.gameOver()) {
+                worker.position.moves(moves);
+                if (moves.empty()) {
+                    break;
+                }
+                worker.seed ^= worker.seed << 13;
+                worker.seed ^= worker.seed >> 7;
+                worker.seed ^= worker.seed << 17;
+                Move move = moves[(int)(worker.seed % (uint64_t)moves.size())];
+                worker.position.play(move);
+                worker.rolloutMoves.push_back(move);
+                plies++;
+            }
+            int winner = worker.position.winner();
+            for (int i = plies; i > 0; i--) {
+                worker.position.undo(worker.rolloutMoves[i - 1]);
+            }
+            return winner;
+        }
+    }
+
+    // finds position in the old trees, up to two plies below the old root, and moves what's below it into fresh arenas
+    // returns the playouts that came with it
+    uint64_t _reroot(const Position &position)
+    {
+        // the same position again, a search spread over several calls, the trees stay where they are
+        if (_workers[0]->root && _workers[0]->position.hash() == position.hash()) {
+            uint64_t reused = 0;
+            for (auto &worker : _workers) {
+                if (_parallelism == ROOT_PARALLEL || worker == _workers[0]) {
+                    reused += worker->root->visits.load(std::memory_order_relaxed);
+                }
+            }
+            return reused;
+        }
+        int fresh = _current ^ 1;
+        uint64_t reused = 0;
+        for (size_t i = 0; i < _workers.size(); i++) {
+            Worker &worker = *_workers[i];
+            worker.arenas[fresh].reset();
+            worker.nodes = 0;
+            // in tree parallel mode the first worker's root is everybody's
+            if (_parallelism == TREE_PARALLEL && i > 0) {
+                worker.position = position;
+                worker.root = _workers[0]->root;
+                continue;
+            }
+            Node *kept = _find(worker, position);
+            worker.position = position;
+            Node *root = worker.arenas[fresh].template allocateArray<Node>(1);
+            worker.nodes = 1;
+            if (kept) {
+                reused += kept->visits.load(std::memory_order_relaxed);
+                _copy(worker, *root, *kept, worker.arenas[fresh]);
+            }
+            worker.root = root;
+        }
+        for (auto &worker : _workers) {
+            worker->arenas[_current].reset();
+        }
+        _current = fresh;
+        return reused;
+    }
+
+    static Node *_find(Worker &worker, const Position &position)
+    {
+        Node *root = worker.root;
+        if (!root) {
+            return nullptr;
+        }
+        if (worker.position.hash() == position.hash()) {
+            return root;
+        }
+        Node *found = nullptr;
+        for (int i = 0; !found && i < root->childCount; i++) {
+            Node &child = root->children[i];
+            worker.position.play(child.move);
+            if (worker.position.hash() == position.hash()) {
+                found = &child;
+            }
+            for (int j = 0; !found && j < child.childCount; j++) {
+                worker.position.play(child.children[j].move);
+                if (worker.position.hash() == position.hash()) {
+                    found = &child.children[j];
+                }
+                worker.position.undo(child.children[j].move);
+            }
+            worker.position.undo(child.move);
+        }
+        return found;
+    }
+
+    // nothing else is running while the tree is copied, relaxed loads are enough
+    void _copy(Worker &worker, Node &to, const Node &from, Arena &arena)
+    {
+        to.move = from.move;
+        to.visits.store(from.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        to.score.store(from.score.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        // a node left half expanded by a stopped search goes back to being a leaf
+        to.state.store(from.state.load(std::memory_order_relaxed) == EXPANDED ? EXPANDED : LEAF, std::memory_order_relaxed);
+        if (!from.childCount) {
+            return;
+        }
+        to.children = arena.template allocateArray<Node>(from.childCount);
+        if (!to.children) {
+            to.state.store(LEAF, std::memory_order_relaxed);
+            return;
+        }
+        to.childCount = from.childCount;
+        worker.nodes += from.childCount;
+        for (int i = 0; i < from.childCount; i++) {
+            _copy(worker, to.children[i], from.children[i], arena);
+        }
+    }
+
+    // first the move chosen from every tree, then the most visited line below it in the first worker's tree,
+    // while its nodes have enough playouts to mean something
+    std::string _pvString(Worker &worker, int first)
+    {
+        std::string text;
+        std::vector<Move> played;
+        const Node *node = &worker.root->children[first];
+        while (true) {
+            if (!text.empty()) {
+                text += ' ';
+            }
+            text += worker.position.moveToString(node->move);
+            worker.position.play(node->move);
+            played.push_back(node->move);
+            if (node->childCount == 0) {
+                break;
+            }
+            const Node *best = &node->children[0];
+            for (int i = 1; i < node->childCount; i++) {
+                if (node->children[i].visits.load(std::memory_order_relaxed) > best->visits.load(std::memory_order_relaxed)) {
+                    best = &node->children[i];
+                }
+            }
+            if (best->visits.load(std::memory_order_relaxed) < _expandVisits) {
+                break;
+            }
+            node = best;
+        }
+        for (size_t i = played.size(); i > 0; i--) {
+            worker.position.undo(played[i - 1]);
+        }
+        return text;
+    }
+
+    double          _exploration;
+    uint32_t        _expandVisits = DEFAULT_EXPAND_VISITS;
+    size_t          _treeBytes = DEFAULT_TREE_BYTES;
+    Parallelism     _parallelism = TREE_PARALLEL;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    int             _current = 0;       // which of each worker's two arenas holds the tree
+    MctsLimits      _limits;
+    std::atomic<bool> _stopped{false};
+    std::atomic<uint64_t> _playouts{0};
+    std::chrono::steady_clock::time_point _start;
+    SearchStats     _stats;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+//
+// fixed capacity list of moves that lives on the stack, search code makes one per node
+//
+template <class Move, int Capacity>
+class MoveList
+{
+public:
+    static const int CAPACITY = Capacity;
+
+    MoveList() : _size(0) {}
+
+    void        clear() { _size = 0; }
+    void        push(const Move &move) { _moves[_size++] = move; }
+    int         size() const { return _size; }
+    bool        empty() const { return _size == 0; }
+
+    Move        &operator[](int index) { return _moves[index]; }
+    const Move  &operator[](int index) const { return _moves[index]; }
+
+    Move        *begin() { return _moves; }
+    Move        *end() { return _moves + _size; }
+    const Move  *begin() const { return _moves; }
+    const Move  *end() const { return _moves + _size; }
+
+private:
+    Move    _moves[Capacity];
+    int     _size;
+};
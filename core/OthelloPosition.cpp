@@ -0,0 +1,240 @@
+#include "OthelloPosition.h"
+#include "BitOps.h"
+
+// move lists take moves by reference, so PASS needs storage
+const int OthelloPosition::PASS;
+
+static const uint64_t kNotFileA = 0xfefefefefefefefeULL;   // x != 0
+static const uint64_t kNotFileH = 0x7f7f7f7f7f7f7f7fULL;   // x != 7
+
+//
+// slide every disc one step in a direction, dropping anything that falls off the side of the board
+// N, NE, E, SE, S, SW, W, NW
+//
+static uint64_t shift(uint64_t discs, int direction)
+{
+    switch (direction) {
+        case 0: return discs >> 8;
+        case 1: return (discs >> 7) & kNotFileA;
+        case 2: return (discs << 1) & kNotFileA;
+        case 3: return (discs << 9) & kNotFileA;
+        case 4: return discs << 8;
+        case 5: return (discs << 7) & kNotFileH;
+        case 6: return (discs >> 1) & kNotFileH;
+        default: return (discs >> 9) & kNotFileH;
+    }
+}
+
+// corners are gold, the squares next to them give corners away
+static const int kSquareWeights[64] = {
+    100, -20,  10,   5,   5,  10, -20, 100,
+    -20, -50,  -2,  -2,  -2,  -2, -50, -20,
+     10,  -2,  -1,  -1,  -1,  -1,  -2,  10,
+      5,  -2,  -1,  -1,  -1,  -1,  -2,   5,
+      5,  -2,  -1,  -1,  -1,  -1,  -2,   5,
+     10,  -2,  -1,  -1,  -1,  -1,  -2,  10,
+    -20, -50,  -2,  -2,  -2,  -2, -50, -20,
+    100, -20,  10,   5,   5,  10, -20, 100
+};
+static const int kMobilityWeight = 5;
+
+OthelloPosition::OthelloPosition()
+{
+    reset();
+}
+
+void OthelloPosition::reset()
+{
+    // standard start, white on d4 and e5, black on e4 and d5
+    _discs[0] = (1ULL << (3 * 8 + 4)) | (1ULL << (4 * 8 + 3));
+    _discs[1] = (1ULL << (3 * 8 + 3)) | (1ULL << (4 * 8 + 4));
+    _side = 0;
+    _plies = 0;
+}
+
+uint64_t OthelloPosition::legalMoves(int player) const
+{
+    uint64_t mine = _discs[player];
+    uint64_t theirs = _discs[player ^ 1];
+    uint64_t empty = ~(mine | theirs);
+    uint64_t legal = 0;
+    for (int direction = 0; direction < 8; direction++) {
+        // runs of their discs starting next to one of ours, at most six long
+        uint64_t run = shift(mine, direction) & theirs;
+        for (int i = 0; i < 5; i++) {
+            run |= shift(run, direction) & theirs;
+        }
+        legal |= shift(run, direction) & empty;
+    }
+    return legal;
+}
+
+uint64_t OthelloPosition::flipsFor(int square) const
+{
+    uint64_t mine = _discs[_side];
+    uint64_t theirs = _discs[_side ^ 1];
+    uint64_t flips = 0;
+    for (int direction = 0; direction < 8; direction++) {
+        uint64_t run = 0;
+        uint64_t next = shift(1ULL << square, direction);
+        while (next & theirs) {
+            run |= next;
+            next = shift(next, direction);
+        }
+        if (next & mine) {
+            flips |= run;
+        }
+    }
+    return flips;
+}
+
+bool OthelloPosition::gameOver() const
+{
+    return legalMoves(0) == 0 && legalMoves(1) == 0;
+}
+
+int OthelloPosition::winner() const
+{
+    if (!gameOver()) {
+        return -1;
+    }
+    int black = discCount(0);
+    int white = discCount(1);
+    if (black == white) {
+        return -1;
+    }
+    return black > white ? 0 : 1;
+}
+
+void OthelloPosition::moves(Moves &list) const
+{
+    list.clear();
+    uint64_t legal = legalMoves(_side);
+    if (legal == 0) {
+        if (legalMoves(_side ^ 1) != 0) {
+            list.push(PASS);
+        }
+        return;
+    }
+    while (legal) {
+        list.push(lowestBit(legal));
+        legal &= legal - 1;
+    }
+}
+
+bool OthelloPosition::canPlay(Move move) const
+{
+    if (move == PASS) {
+        return legalMoves(_side) == 0 && legalMoves(_side ^ 1) != 0;
+    }
+    return move >= 0 && move < 64 && (legalMoves(_side) & (1ULL << move)) != 0;
+}
+
+void OthelloPosition::play(Move move)
+{
+    uint64_t flips = 0;
+    if (move != PASS) {
+        flips = flipsFor(move);
+        _discs[_side] |= flips | (1ULL << move);
+        _discs[_side ^ 1] &= ~flips;
+    }
+    _flipped[_plies++] = flips;
+    _side ^= 1;
+}
+
+void OthelloPosition::undo(Move move)
+{
+    _side ^= 1;
+    uint64_t flips = _flipped[--_plies];
+    if (move != PASS) {
+        _discs[_side] &= ~(flips | (1ULL << move));
+        _discs[_side ^ 1] |= flips;
+    }
+}
+
+int OthelloPosition::eval() const
+{
+    int score = 0;
+    for (int player = 0; player < 2; player++) {
+        int sign = player == _side ? 1 : -1;
+        uint64_t discs = _discs[player];
+        while (discs) {
+            score += sign * kSquareWeights[lowestBit(discs)];
+            discs &= discs - 1;
+        }
+        score += sign * kMobilityWeight * popCount(legalMoves(player));
+    }
+    return score;
+}
+
+uint64_t OthelloPosition::hash() const
+{
+    return combineHash(mixHash(_discs[0]) ^ (uint64_t)_side, _discs[1]);
+}
+
+int OthelloPosition::pieceAt(int square) const
+{
+    if (_discs[0] & (1ULL << square)) return 0;
+    if (_discs[1] & (1ULL << square)) return 1;
+    return -1;
+}
+
+int OthelloPosition::discCount(int player) const
+{
+    return popCount(_discs[player]);
+}
+
+std::string OthelloPosition::stateString() const
+{
+    std::string state(64, '0');
+    for (int square = 0; square < 64; square++) {
+        state[square] = (char)('1' + pieceAt(square));
+    }
+    return state;
+}
+
+bool OthelloPosition::setStateString(const std::string &s)
+{
+    if (s.length() != 64) {
+        return false;
+    }
+    uint64_t discs[2] = { 0, 0 };
+    for (int square = 0; square < 64; square++) {
+        if (s[square] == '1') {
+            discs[0] |= 1ULL << square;
+        } else if (s[square] == '2') {
+            discs[1] |= 1ULL << square;
+        } else if (s[square] != '0') {
+            return false;
+        }
+    }
+    _discs[0] = discs[0];
+    _discs[1] = discs[1];
+    // every placement adds one disc, so without passes the parity tells whose turn it is
+    _side = (popCount(discs[0] | discs[1]) - 4) & 1;
+    _plies = 0;
+    return true;
+}
+
+std::string OthelloPosition::moveToString(Move move) const
+{
+    if (move == PASS) {
+        return "pass";
+    }
+    std::string text;
+    text += (char)('a' + move % 8);
+    text += (char)('1' + move / 8);
+    return text;
+}
+
+bool OthelloPosition::parseMove(const std::string &text, Move &move) const
+{
+    if (text == "pass") {
+        move = PASS;
+    } else if (text.length() == 2 && text[0] >= 'a' && text[0] <= 'h' && text[1] >= '1' && text[1] <= '8') {
+        move = (text[1] - '1') * 8 + (text[0] - 'a');
+    } else {
+        return false;
+    }
+    return canPlay(move);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "MoveList.h"
+#include <cstdint>
+#include <string>
+
+//
+// othello rules on a pair of 64 bit boards, no rendering
+// square = y * 8 + x with y = 0 the top row, player 0 is black and moves first
+// a side with no legal placement has to pass, the game ends when neither side can place
+//
+class OthelloPosition
+{
+public:
+    static const int PASS = 64;
+    static const int MAX_PLIES = 128;
+
+    typedef int Move;   // square to place on, or PASS
+    typedef MoveList<Move, 64> Moves;
+
+    OthelloPosition();
+
+    void        reset();
+
+    // legal placements, just PASS when the side to move is stuck but the game isn't over
+    void        moves(Moves &list) const;
+    bool        canPlay(Move move) const;
+    void        play(Move move);
+    void        undo(Move move);
+
+    int         sideToMove() const { return _side; }
+    void        setSideToMove(int side) { _side = side; }
+    int         plies() const { return _plies; }
+    bool        gameOver() const;
+    // player with more discs once the game is over, -1 while playing or on a tie
+    int         winner() const;
+    // positional score from the side to move's point of view
+    int         eval() const;
+    uint64_t    hash() const;
+
+    // -1 for an empty square, otherwise the player number
+    int         pieceAt(int square) const;
+    int         discCount(int player) const;
+    // bitboard of the squares the player could place on
+    uint64_t    legalMoves(int player) const;
+    // discs that playing square would turn over for the side to move
+    uint64_t    flipsFor(int square) const;
+
+    // '0' empty, '1' black, '2' white, the side to move is guessed from the disc count
+    std::string stateString() const;
+    bool        setStateString(const std::string &s);
+
+    // squares are written a1 to h8 with a1 top left, passing is "pass"
+    std::string moveToString(Move move) const;
+    bool        parseMove(const std::string &text, Move &move) const;
+
+private:
+    uint64_t    _discs[2];
+    int         _side;
+    int         _plies;
+    // discs each played move turned over, so undo can turn them back
+    uint64_t    _flipped[MAX_PLIES];
+};
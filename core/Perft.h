@@ -0,0 +1,87 @@
+#pragma once
+#include "Scheduler.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+//
+// perft counts every line of play to a fixed depth, the standard check that move generation is right
+// published counts for known positions catch missing or extra moves that playing games never would
+// works on any core position with moves(), play() and undo()
+//
+template <class Position>
+uint64_t perft(Position &position, int depth)
+{
+    if (depth <= 0) {
+        return 1;
+    }
+    typename Position::Moves moves;
+    position.moves(moves);
+    // the last ply only needs counting, not playing
+    if (depth == 1) {
+        return (uint64_t)moves.size();
+    }
+    uint64_t nodes = 0;
+    for (const auto &move : moves) {
+        position.play(move);
+        nodes += perft(position, depth - 1);
+        position.undo(move);
+    }
+    return nodes;
+}
+
+// the count below each root move, a wrong total is tracked down by comparing these with a trusted engine
+template <class Position>
+struct PerftDivide
+{
+    std::vector<typename Position::Move> moves;
+    std::vector<uint64_t> nodes;
+    uint64_t    total = 0;
+};
+
+//
+// perft with the root moves shared out across scheduler tasks, each task takes the next root move as it finishes one
+//
+template <class Position>
+PerftDivide<Position> perftDivide(const Position &position, int depth, int threads)
+{
+    PerftDivide<Position> result;
+    typename Position::Moves moves;
+    position.moves(moves);
+    result.moves.assign(moves.begin(), moves.end());
+    result.nodes.assign(moves.size(), 0);
+    if (depth <= 0) {
+        result.total = 1;
+        return result;
+    }
+
+    std::atomic<int> next(0);
+    auto work = [&](const std::atomic<bool> &stop) {
+        Position local = position;
+        for (int i = next++; i < moves.size(); i = next++) {
+            local.play(moves[i]);
+            result.nodes[i] = perft(local, depth - 1);
+            local.undo(moves[i]);
+        }
+        return true;
+    };
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (threads > moves.size()) {
+        threads = moves.size() > 0 ? moves.size() : 1;
+    }
+    std::vector<TaskHandle> tasks;
+    for (int i = 1; i < threads; i++) {
+        tasks.push_back(Scheduler::shared().submit(work, Scheduler::currentPriority(), "perft"));
+    }
+    std::atomic<bool> never(false);
+    work(never);
+    for (TaskHandle &task : tasks) {
+        task.wait();
+    }
+    for (uint64_t nodes : result.nodes) {
+        result.total += nodes;
+    }
+    return result;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "Scheduler.h"
+#include <atomic>
+#include <functional>
+
+//
+// runs a search as background work on the shared scheduler while the human thinks
+// the work is handed a stop flag it has to watch, stop() raises it and waits,
+// so once stop() returns whatever the work was using belongs to the caller again
+// urgent work stops it too, and it's started again from the top once that's done,
+// searches keep their tables so the second go catches up quickly
+//
+class Ponder
+{
+public:
+    typedef std::function<void(const std::atomic<bool> &stop)> Work;
+
+    Ponder() {}
+    ~Ponder() { stop(); }
+
+    void start(const Work &work)
+    {
+        stop();
+        _task = Scheduler::shared().submit([work](const std::atomic<bool> &stop) {
+            work(stop);
+            return !stop.load();
+        }, Scheduler::BACKGROUND, "ponder");
+    }
+
+    void stop()
+    {
+        _task.cancel();
+        _task.wait();
+        _task = TaskHandle();
+    }
+
+    bool active() const { return _task.valid(); }
+
+private:
+    TaskHandle  _task;
+};
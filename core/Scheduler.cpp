@@ -0,0 +1,301 @@
+#include "Scheduler.h"
+#include "Trace.h"
+#include <string>
+
+struct ScheduledTask
+{
+    enum State { QUEUED, RUNNING, DONE };
+
+    Scheduler::Work     work;
+    Scheduler::Priority priority;
+    const char          *name;
+    std::atomic<int>    state{ QUEUED };
+    std::atomic<bool>   stop{ false };         // what the work watches, raised to cancel or to preempt
+    std::atomic<bool>   cancelled{ false };
+};
+
+// which pool the calling thread works for, and what it's running at
+static thread_local Scheduler *tls_scheduler = nullptr;
+static thread_local int tls_worker = -1;
+static thread_local Scheduler::Priority tls_priority = Scheduler::NORMAL;
+
+void TaskHandle::cancel()
+{
+    if (_task) {
+        _task->cancelled = true;
+        _task->stop = true;
+    }
+}
+
+bool TaskHandle::done() const
+{
+    return !_task || _task->state.load() == ScheduledTask::DONE;
+}
+
+void TaskHandle::wait()
+{
+    if (!_task) {
+        return;
+    }
+    while (true) {
+        int state = _task->state.load();
+        if (state == ScheduledTask::DONE) {
+            return;
+        }
+        // nobody has got to it, quicker to run it here than to sit and wait for a worker
+        if (state == ScheduledTask::QUEUED && _scheduler->_claim(*_task)) {
+            _scheduler->_run(_task, nullptr);
+            continue;
+        }
+        _task->state.wait(state);
+    }
+}
+
+Scheduler &Scheduler::shared()
+{
+    static Scheduler *scheduler = new Scheduler();
+    return *scheduler;
+}
+
+Scheduler::Scheduler(int threads)
+{
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+    }
+    if (threads <= 0) {
+        threads = 1;
+    }
+    for (std::atomic<int> &queued : _queued) {
+        queued = 0;
+    }
+    for (int i = 0; i < threads; i++) {
+        _workers.push_back(std::make_unique<Worker>());
+    }
+    // started once every worker exists, they steal from each other from the first moment
+    for (int i = 0; i < threads; i++) {
+        _workers[i]->thread = std::thread([this, i]() { _workerLoop(i); });
+    }
+}
+
+Scheduler::~Scheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _quit = true;
+    }
+    _wake.notify_all();
+    for (auto &worker : _workers) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        if (worker->running) {
+            worker->running->cancelled = true;
+            worker->running->stop = true;
+        }
+    }
+    for (auto &worker : _workers) {
+        worker->thread.join();
+    }
+    // whatever never started is done as far as anyone waiting on it is concerned
+    for (auto &worker : _workers) {
+        for (auto &queue : worker->queues) {
+            for (auto &task : queue) {
+                if (_claim(*task)) {
+                    task->cancelled = true;
+                    _run(task, nullptr);
+                }
+            }
+        }
+    }
+}
+
+Scheduler::Priority Scheduler::currentPriority()
+{
+    return tls_priority;
+}
+
+TaskHandle Scheduler::submit(const Work &work, Priority priority, const char *name)
+{
+    auto task = std::make_shared<ScheduledTask>();
+    task->work = work;
+    task->priority = priority;
+    task->name = name;
+    if (priority == URGENT) {
+        _urgentBegin();
+    }
+    _queued[priority]++;
+    _push(task);
+    return TaskHandle(this, task);
+}
+
+Scheduler::Urgent::Urgent(Scheduler &scheduler) : _scheduler(scheduler), _previous(tls_priority)
+{
+    _scheduler._urgentBegin();
+    tls_priority = URGENT;
+}
+
+Scheduler::Urgent::~Urgent()
+{
+    tls_priority = _previous;
+    _scheduler._urgentEnd();
+}
+
+void Scheduler::_workerLoop(int index)
+{
+    tls_scheduler = this;
+    tls_worker = index;
+    Tracer::shared().setThreadName("worker " + std::to_string(index));
+    Worker &worker = *_workers[index];
+    while (true) {
+        if (std::shared_ptr<ScheduledTask> task = _take(index)) {
+            _run(task, &worker);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _wake.wait(lock, [this]() { return _quit || _runnable(); });
+        if (_quit) {
+            break;
+        }
+    }
+}
+
+bool Scheduler::_runnable() const
+{
+    return _queued[URGENT].load() > 0 || _queued[NORMAL].load() > 0 || (_urgent.load() == 0 && _queued[BACKGROUND].load() > 0);
+}
+
+std::shared_ptr<ScheduledTask> Scheduler::_take(int index)
+{
+    int count = (int)_workers.size();
+    for (int priority = 0; priority < PRIORITIES; priority++) {
+        if (priority == BACKGROUND && _urgent.load() > 0) {
+            break;
+        }
+        if (_queued[priority].load() <= 0) {
+            continue;
+        }
+        if (std::shared_ptr<ScheduledTask> task = _pop(*_workers[index], priority, true)) {
+            return task;
+        }
+        for (int i = 1; i < count; i++) {
+            if (std::shared_ptr<ScheduledTask> task = _pop(*_workers[(index + i) % count], priority, false)) {
+                return task;
+            }
+        }
+    }
+    return nullptr;
+}
+
+//
+// the first task off one end of a worker's deque that can still be claimed
+// tasks a waiter already ran for itself are left in the deques and thrown away here
+//
+std::shared_ptr<ScheduledTask> Scheduler::_pop(Worker &worker, int priority, bool newest)
+{
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    std::deque<std::shared_ptr<ScheduledTask>> &queue = worker.queues[priority];
+    while (!queue.empty()) {
+        std::shared_ptr<ScheduledTask> task;
+        if (newest) {
+            task = std::move(queue.back());
+            queue.pop_back();
+        } else {
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+        if (_claim(*task)) {
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+bool Scheduler::_claim(ScheduledTask &task)
+{
+    int expected = ScheduledTask::QUEUED;
+    if (!task.state.compare_exchange_strong(expected, ScheduledTask::RUNNING)) {
+        return false;
+    }
+    _queued[task.priority]--;
+    return true;
+}
+
+void Scheduler::_push(const std::shared_ptr<ScheduledTask> &task)
+{
+    int index = tls_scheduler == this ? tls_worker : (int)(_nextWorker++ % _workers.size());
+    {
+        Worker &worker = *_workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queues[task->priority].push_back(task);
+    }
+    {
+        // taken so a worker between finding nothing and going to sleep can't miss this
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+    }
+    _wake.notify_one();
+}
+
+void Scheduler::_run(const std::shared_ptr<ScheduledTask> &task, Worker *worker)
+{
+    bool finished = true;
+    if (!task->cancelled) {
+        if (worker) {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->running = task;
+        }
+        // urgent work may have arrived between taking this and getting it on the running list
+        if (task->priority == BACKGROUND && _urgent.load() > 0) {
+            task->stop = true;
+        }
+        Priority previous = tls_priority;
+        tls_priority = task->priority;
+        {
+            TraceScope scope(task->name, "scheduler");
+            finished = task->work(task->stop);
+        }
+        tls_priority = previous;
+        if (worker) {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->running = nullptr;
+        }
+    }
+
+    if (!finished && task->priority == BACKGROUND && !task->cancelled) {
+        // preempted, back on the queue to start again once the urgent work is out of the way
+        // a cancel landing meanwhile still counts, it raises stop after cancelled so one of these sees it
+        task->stop = false;
+        if (task->cancelled) {
+            task->stop = true;
+        }
+        _queued[BACKGROUND]++;
+        task->state = ScheduledTask::QUEUED;
+        task->state.notify_all();
+        _push(task);
+        return;
+    }
+    task->state = ScheduledTask::DONE;
+    task->state.notify_all();
+    if (task->priority == URGENT) {
+        _urgentEnd();
+    }
+}
+
+void Scheduler::_urgentBegin()
+{
+    _urgent++;
+    for (auto &worker : _workers) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        if (worker->running && worker->running->priority == BACKGROUND) {
+            worker->running->stop = true;
+        }
+    }
+}
+
+void Scheduler::_urgentEnd()
+{
+    if (_urgent.fetch_sub(1) == 1) {
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+        }
+        // background work held back may go now
+        _wake.notify_all();
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Scheduler;
+struct ScheduledTask;
+
+//
+// what submit() gives back, the task's cancellation token as well as the way to wait for it
+// copies all refer to the same task, an empty handle is done already
+//
+class TaskHandle
+{
+public:
+    TaskHandle() {}
+
+    // raise the task's stop flag, one that hasn't started never will
+    void cancel();
+    // true once the work has returned for good, or was cancelled before it started
+    bool done() const;
+    // block until done(), a task no worker has picked up yet is run right here instead
+    void wait();
+
+    bool valid() const { return _task != nullptr; }
+
+private:
+    friend class Scheduler;
+    TaskHandle(Scheduler *scheduler, const std::shared_ptr<ScheduledTask> &task) : _scheduler(scheduler), _task(task) {}
+
+    Scheduler                       *_scheduler = nullptr;
+    std::shared_ptr<ScheduledTask>  _task;
+};
+
+//
+// one pool of worker threads for the whole process, the AI, pondering, analysis, tournaments and perft all hand it
+// their work instead of starting threads of their own, so they share the cores rather than fight over them
+// every worker keeps a deque per priority, work submitted from a worker goes on its own deque and comes back off the
+// same end, newest first while it's still in cache, an idle worker steals the oldest from the other end of someone else's
+// urgent work goes before normal, and background work only runs while nothing urgent is queued or running,
+// background tasks already running when urgent work turns up have their stop flag raised and go back on the queue,
+// they start over once it's done
+//
+class Scheduler
+{
+public:
+    //   URGENT      the AI deciding the move being waited for
+    //   NORMAL      everything else, tournaments, perft, batch work
+    //   BACKGROUND  pondering and analysis, gives way to urgent work
+    enum Priority { URGENT, NORMAL, BACKGROUND };
+    static const int PRIORITIES = 3;
+
+    // the work watches stop and returns false if it gave up early because of it
+    // a background task that gave up and wasn't cancelled is run again later
+    typedef std::function<bool(const std::atomic<bool> &stop)> Work;
+
+    // the process's pool, one worker per core, never destroyed so objects that outlive main can still stop their work
+    static Scheduler &shared();
+
+    // threads 0 for one per core
+    explicit Scheduler(int threads = 0);
+    ~Scheduler();
+    Scheduler(const Scheduler &) = delete;
+    Scheduler &operator=(const Scheduler &) = delete;
+
+    int         threads() const { return (int)_workers.size(); }
+
+    // name is what the task shows up as in a trace, it has to outlive the task
+    TaskHandle  submit(const Work &work, Priority priority = currentPriority(), const char *name = "task");
+
+    // the priority of the task running on this thread, so helpers it submits go in at the same one
+    // NORMAL on threads outside the pool unless an Urgent scope says otherwise
+    static Priority currentPriority();
+
+    //
+    // urgent work done on a thread outside the pool, the render thread searching for the AI's move
+    // background tasks stay stopped while one is alive, and tasks submitted from this thread meanwhile are urgent too
+    //
+    class Urgent
+    {
+    public:
+        explicit Urgent(Scheduler &scheduler = shared());
+        ~Urgent();
+        Urgent(const Urgent &) = delete;
+        Urgent &operator=(const Urgent &) = delete;
+
+    private:
+        Scheduler   &_scheduler;
+        Priority    _previous;
+    };
+
+private:
+    friend class TaskHandle;
+
+    struct Worker
+    {
+        std::mutex                                  mutex;
+        std::deque<std::shared_ptr<ScheduledTask>>  queues[PRIORITIES];
+        std::shared_ptr<ScheduledTask>              running;
+        std::thread                                 thread;
+    };
+
+    void        _workerLoop(int index);
+    bool        _runnable() const;
+    std::shared_ptr<ScheduledTask> _take(int index);
+    std::shared_ptr<ScheduledTask> _pop(Worker &worker, int priority, bool newest);
+    bool        _claim(ScheduledTask &task);
+    void        _push(const std::shared_ptr<ScheduledTask> &task);
+    void        _run(const std::shared_ptr<ScheduledTask> &task, Worker *worker);
+    void        _urgentBegin();
+    void        _urgentEnd();
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::atomic<int>        _queued[PRIORITIES];
+    std::atomic<int>        _urgent{ 0 };      // urgent tasks queued or running, and Urgent scopes alive
+    std::atomic<unsigned>   _nextWorker{ 0 };  // where work from outside the pool goes, round robin
+    std::mutex              _sleepMutex;
+    std::condition_variable _wake;
+    bool                    _quit = false;
+};
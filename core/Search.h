@@ -0,0 +1,727 @@
+#pragma once
+#include "SearchStats.h"
+#include "Trace.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+//
+// principal variation search shared by every game's AI
+// works on any core position that provides
+//   Move, Moves, moves(), play(), undo(), gameOver(), winner(), sideToMove(), eval(), hash() and moveToString()
+// and a moveCode() for its Move, 16 bits that tell it apart from the position's other moves
+//
+const int SEARCH_WIN_SCORE = 1000000;
+const int SEARCH_INFINITY = SEARCH_WIN_SCORE + 1;
+const int SEARCH_MAX_PLY = 64;
+
+// a finished game scored from the side to move's point of view, quicker wins score higher
+template <class Position>
+int terminalScore(const Position &position, int ply)
+{
+    int winner = position.winner();
+    if (winner < 0) {
+        return 0;
+    }
+    return winner == position.sideToMove() ? SEARCH_WIN_SCORE - ply : -(SEARCH_WIN_SCORE - ply);
+}
+
+// true for scores that mean somebody has a forced win
+inline bool isWinScore(int score)
+{
+    return score > SEARCH_WIN_SCORE - SEARCH_MAX_PLY || score < -(SEARCH_WIN_SCORE - SEARCH_MAX_PLY);
+}
+
+// games whose moves are small numbers already have their code
+inline uint16_t moveCode(int move)
+{
+    return (uint16_t)move;
+}
+
+// the list above, a position missing any of it fails here instead of somewhere inside the search
+template <class P>
+concept SearchPosition = requires(P &position, const P &constPosition, typename P::Moves &moves, const typename P::Move &move) {
+    constPosition.moves(moves);
+    position.play(move);
+    position.undo(move);
+    { constPosition.gameOver() } -> std::convertible_to<bool>;
+    { constPosition.winner() } -> std::convertible_to<int>;
+    { constPosition.sideToMove() } -> std::convertible_to<int>;
+    { constPosition.eval() } -> std::convertible_to<int>;
+    { constPosition.hash() } -> std::convertible_to<uint64_t>;
+    { constPosition.moveToString(move) } -> std::convertible_to<std::string>;
+    { moveCode(move) } -> std::convertible_to<uint16_t>;
+};
+
+//
+// how long a search may run, whichever limit is hit first ends it
+//
+struct SearchLimits
+{
+    int                     depth = SEARCH_MAX_PLY;
+    int64_t                 movetime = 0;       // milliseconds, 0 for no limit
+    int                     multiPv = 1;        // root moves to find an exact score and line for, best first
+    const std::atomic<bool> *stop = nullptr;    // set from another thread to stop early
+};
+
+template <class Position>
+struct SearchResult
+{
+    // one root move's score and the line that gets it
+    struct Line
+    {
+        typename Position::Move move{};
+        int         score = 0;
+        std::vector<typename Position::Move> pv;    // starts with move
+    };
+
+    typename Position::Move bestMove{};
+    bool        found = false;      // false when there was nothing to play
+    int         score = 0;          // from the side to move's point of view
+    int         depth = 0;          // last depth that finished
+    uint64_t    nodes = 0;
+    int64_t     milliseconds = 0;
+    std::vector<typename Position::Move> pv;
+    // with multiPv above 1, that many root moves from the last depth that finished, best first
+    std::vector<Line> lines;
+};
+
+//
+// iterative deepening principal variation search, each finished depth is reported and
+// the best line from the last one is searched first in the next
+// Derived is the game's own searcher, it changes how the search orders, prunes, extends and stops by declaring
+// a hook below again under the same name, calls go through Derived so they're resolved at compile time
+// and inline like any other, there's nothing virtual on the way down the tree
+// positions seen before are looked up in Table, which lasts between searches and can be shared with other searchers
+//
+template <class Derived, SearchPosition Position, class Table = TranspositionTable>
+class AlphaBeta
+{
+public:
+    typedef typename Position::Move Move;
+    typedef typename Position::Moves Moves;
+    typedef SearchResult<Position> Result;
+    typedef typename Result::Line Line;
+    typedef std::function<void(const Result &)> IterationCallback;
+
+    AlphaBeta(size_t tableMegabytes) { setTableSize(tableMegabytes); }
+    AlphaBeta(const AlphaBeta &) = delete;
+    AlphaBeta &operator=(const AlphaBeta &) = delete;
+
+    // megabytes of transposition table, 0 turns it off, see TranspositionTable::resize
+    void setTableSize(size_t megabytes, bool hugePages = false) { _table->resize(megabytes, hugePages); }
+    void clearTable() { _table->clear(); }
+
+    // search with another searcher's table from now on, this one's own is freed
+    // the other searcher has to outlive this one, and may be searching at the same time on another thread
+    void shareTable(Table &table)
+    {
+        _ownTable.resize(0);
+        _table = &table;
+    }
+    Table &table() { return *_table; }
+
+    // numbers from the last search, kept until the next one starts
+    const SearchStats &stats() const { return _stats; }
+
+    Result search(Position &position, const SearchLimits &limits, const IterationCallback &onIteration = nullptr)
+    {
+        TraceScope searchScope("search", "search");
+        _start = std::chrono::steady_clock::now();
+        Result result;
+        if (!_startSearch(position, limits, result)) {
+            return result;
+        }
+        int score = 0;
+        for (int depth = 1; depth <= _maxDepth(); depth++) {
+            uint64_t nodesBefore = _stats.nodes;
+            int64_t startedAt = _elapsedMicroseconds();
+            _followPv = true;
+            std::vector<Line> lines;
+            {
+                TraceScope iterationScope("iteration", "search", "depth", depth);
+                if (limits.multiPv > 1) {
+                    score = _multiPvRoot(position, depth, limits.multiPv, result.lines, lines);
+                } else {
+                    int alpha, beta;
+                    _rootWindow(depth, score, alpha, beta);
+                    do {
+                        score = _search(position, depth, 0, alpha, beta);
+                    } while (_widenRoot(score, alpha, beta));
+                }
+            }
+            if (!_finishDepth(position, depth, score, nodesBefore, startedAt, lines, result, onIteration)) {
+                break;
+            }
+        }
+        _finishSearch(result);
+        return result;
+    }
+
+protected:
+    //
+    // the hooks, these are what a plain game gets
+    //
+
+    // before the first depth of every search
+    void onSearchStart() {}
+
+    // the window to search depth from the root with, previous is the last depth's score
+    void rootWindow(int depth, int previous, int &alpha, int &beta)
+    {
+        alpha = -SEARCH_INFINITY;
+        beta = SEARCH_INFINITY;
+    }
+
+    // true with the window moved to search the root again, score having fallen outside it
+    bool widenRoot(int score, int &alpha, int &beta) { return false; }
+
+    // another depth after one that finished now microseconds into the search?
+    bool keepDeepening(int depth, int score, int64_t now) { return !isWinScore(score); }
+
+    // true with score set if the position below the root is decided without looking at its moves
+    bool isTerminal(Position &position, int ply, int &score)
+    {
+        if (!position.gameOver()) {
+            return false;
+        }
+        score = terminalScore(position, ply);
+        return true;
+    }
+
+    // plies to search this node deeper than it was asked to
+    int extension(Position &position, int ply) { return 0; }
+
+    // score for a node the depth has run out at
+    int leafScore(Position &position, int ply, int alpha, int beta)
+    {
+        _stats.nodes++;
+        return position.eval();
+    }
+
+    // true with score set to give up on a node before its moves are generated
+    bool prune(Position &position, int depth, int ply, int alpha, int beta, int &score) { return false; }
+
+    // plies less than usual to search a pass with, 0 not to try one, nullMove if the node is the reply to a pass
+    // a pass that still gets to beta gives up on the node, games that try one say how to play it below
+    int nullMoveReduction(Position &position, int depth, int ply, int alpha, int beta, bool nullMove) { return 0; }
+    void playNull(Position &position) {}
+    void undoNull(Position &position) {}
+
+    // a node with no moves that wasn't terminal, only games where being stuck isn't game over have these
+    int noMovesScore(Position &position, int ply) { return terminalScore(position, ply); }
+
+    // order the moves before any are searched, first is last depth's best or the table's, if there is one
+    void orderMoves(Position &position, Moves &moves, const Move *first, int ply)
+    {
+        if (first) {
+            _moveToFront(moves, *first);
+        }
+    }
+
+    // just before moves[index] is searched, for orderings that pick each move as they go
+    void pickMove(Moves &moves, int index, int ply) {}
+
+    // plies less to try a move after the first with, position has the move played
+    // a reduced move that beats alpha is searched again at full depth
+    int reduction(Position &position, const Move &move, int depth, int index, bool pvNode, int ply) { return 0; }
+
+    // move just caused a beta cutoff, position is back to before it
+    void onCutoff(Position &position, const Move &move, int depth, int ply) {}
+
+    // search the last depth's best line first even when the table has forgotten it
+    static const bool FOLLOW_PV = true;
+
+    //
+    // iterative deepening in stages, search() runs them in one go and SlicedSearcher a few milliseconds at a time
+    //
+
+    Derived &_derived() { return static_cast<Derived &>(*this); }
+
+    // everything before the first depth, false when there's nothing to play, the clock is started by the caller
+    bool _startSearch(Position &position, const SearchLimits &limits, Result &result)
+    {
+        _limits = limits;
+        _stopped = false;
+        _stats.reset();
+        _table->newSearch();
+        _derived().onSearchStart();
+        _hintLength = 0;
+
+        Moves moves;
+        position.moves(moves);
+        if (moves.empty()) {
+            return false;
+        }
+        result.found = true;
+        result.bestMove = moves[0];
+        return true;
+    }
+
+    int _maxDepth() const { return _limits.depth < SEARCH_MAX_PLY ? _limits.depth : SEARCH_MAX_PLY - 1; }
+
+    void _rootWindow(int depth, int previous, int &alpha, int &beta) { _derived().rootWindow(depth, previous, alpha, beta); }
+    bool _widenRoot(int score, int &alpha, int &beta) { return !_stopped && _derived().widenRoot(score, alpha, beta); }
+
+    // takes in a depth that has been searched, false once there shouldn't be another
+    bool _finishDepth(Position &position, int depth, int score, uint64_t nodesBefore, int64_t startedAt, const std::vector<Line> &lines,
+                      Result &result, const IterationCallback &onIteration)
+    {
+        // a depth cut short is only trusted if it's all we have
+        if (_stopped && depth > 1) {
+            return false;
+        }
+        result.depth = depth;
+        result.score = score;
+        if (_limits.multiPv > 1) {
+            result.lines = lines;
+        }
+        result.pv.assign(_pv[0], _pv[0] + _pvLength[0]);
+        if (!result.pv.empty()) {
+            result.bestMove = result.pv[0];
+        }
+        _hintLength = _pvLength[0];
+        for (int i = 0; i < _hintLength; i++) {
+            _hint[i] = _pv[0][i];
+        }
+
+        int64_t now = _elapsedMicroseconds();
+        _stats.iterations.push_back({ depth, score, _stats.nodes - nodesBefore, now - startedAt });
+        _stats.depth = depth;
+        _stats.score = score;
+        _stats.pv = _pvString(position, result.pv);
+        _stats.tableFill = _table->fillPerMille();
+        _stats.tableBytes = _table->bytes();
+        result.nodes = _stats.nodes;
+        result.milliseconds = now / 1000;
+
+        if (onIteration) {
+            onIteration(result);
+        }
+        return !_stopped && _derived().keepDeepening(depth, score, now);
+    }
+
+    void _finishSearch(Result &result)
+    {
+        _stats.microseconds = _elapsedMicroseconds();
+        result.nodes = _stats.nodes;
+        result.milliseconds = _stats.microseconds / 1000;
+    }
+
+    int64_t _elapsedMicroseconds() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start).count();
+    }
+
+    // looking at the clock every node is too slow, every 1024 is plenty
+    bool _checkStop()
+    {
+        if ((_stats.nodes & 1023) == 0) {
+            if ((_limits.stop && _limits.stop->load(std::memory_order_relaxed)) ||
+                (_limits.movetime > 0 && _elapsedMicroseconds() >= _limits.movetime * 1000)) {
+                _stopped = true;
+            }
+        }
+        return _stopped;
+    }
+
+    // wins are stored counted from the stored position, not the root, so they stay right wherever it turns up again
+    static int _scoreToTable(int score, int ply)
+    {
+        if (score > SEARCH_WIN_SCORE - SEARCH_MAX_PLY) return score + ply;
+        if (score < -(SEARCH_WIN_SCORE - SEARCH_MAX_PLY)) return score - ply;
+        return score;
+    }
+
+    static int _scoreFromTable(int score, int ply)
+    {
+        if (score > SEARCH_WIN_SCORE - SEARCH_MAX_PLY) return score - ply;
+        if (score < -(SEARCH_WIN_SCORE - SEARCH_MAX_PLY)) return score + ply;
+        return score;
+    }
+
+    static void _moveToFront(Moves &moves, const Move &move)
+    {
+        for (int i = 1; i < moves.size(); i++) {
+            if (moves[i] == move) {
+                moves[i] = moves[0];
+                moves[0] = move;
+                return;
+            }
+        }
+    }
+
+    std::string _pvString(Position &position, const std::vector<Move> &pv) const
+    {
+        // each move is written in the position it's played from
+        std::string text;
+        for (const Move &move : pv) {
+            if (!text.empty()) {
+                text += ' ';
+            }
+            text += position.moveToString(move);
+            position.play(move);
+        }
+        for (size_t i = pv.size(); i > 0; i--) {
+            position.undo(pv[i - 1]);
+        }
+        return text;
+    }
+
+    //
+    // the root for multi-pv, every move is searched with a window only the multiPv best so far can get inside,
+    // so those come out exact and the rest only have to be shown worse
+    // moves go in last depth's order so the good ones set the window early
+    //
+    int _multiPvRoot(Position &position, int depth, int multiPv, const std::vector<Line> &previous, std::vector<Line> &lines)
+    {
+        _stats.nodes++;
+        _stats.interiorNodes++;
+        _pvLength[0] = 0;
+        Moves moves;
+        position.moves(moves);
+        for (int i = (int)previous.size() - 1; i >= 0; i--) {
+            _moveToFront(moves, previous[i].move);
+        }
+
+        std::vector<int> best;  // scores of the lines kept so far, best first
+        for (int i = 0; i < moves.size(); i++) {
+            const Move &move = moves[i];
+            int alpha = (int)best.size() < multiPv ? -SEARCH_INFINITY : best[multiPv - 1];
+            _followPv = false;
+            _stats.movesSearched++;
+            position.play(move);
+            int score = -_search(position, depth - 1, 1, -SEARCH_INFINITY, -alpha);
+            position.undo(move);
+            if (_stopped) {
+                break;
+            }
+            if (score <= alpha) {
+                continue;
+            }
+            Line line;
+            line.move = move;
+            line.score = score;
+            line.pv.push_back(move);
+            line.pv.insert(line.pv.end(), _pv[1], _pv[1] + _pvLength[1]);
+            // keep lines sorted, ties stay in the order they were searched
+            size_t at = 0;
+            while (at < lines.size() && lines[at].score >= score) {
+                at++;
+            }
+            lines.insert(lines.begin() + at, line);
+            best.insert(best.begin() + at, score);
+            if ((int)lines.size() > multiPv) {
+                lines.pop_back();
+                best.pop_back();
+            }
+        }
+        if (lines.empty()) {
+            return -SEARCH_INFINITY;
+        }
+        // the best line is the principal variation the rest of the search knows about
+        _pvLength[0] = (int)lines[0].pv.size() < SEARCH_MAX_PLY ? (int)lines[0].pv.size() : SEARCH_MAX_PLY;
+        for (int i = 0; i < _pvLength[0]; i++) {
+            _pv[0][i] = lines[0].pv[i];
+        }
+        return lines[0].score;
+    }
+
+    //
+    // the first move gets the full window, the rest only have to be shown no better with a null window
+    // and are searched again properly when one isn't
+    // each node is the stages below run in order, SlicedSearcher runs the same ones with co_await in place of the calls
+    //
+    int _search(Position &position, int depth, int ply, int alpha, int beta, bool nullMove = false)
+    {
+        Node node;
+        int score;
+        if (_enter(position, node, depth, ply, alpha, beta, score)) {
+            return score;
+        }
+        if (int reduction = _playNull(position, node, nullMove)) {
+            int nullScore = -_search(position, node.depth - 1 - reduction, ply + 1, -node.beta, -node.beta + 1, true);
+            if (_undoNull(position, node, nullScore, score)) {
+                return score;
+            }
+        }
+        Moves moves;
+        if (_expand(position, node, moves, score)) {
+            return score;
+        }
+        for (int i = 0; i < moves.size(); i++) {
+            int reduction;
+            const Move move = _playMove(position, node, moves, i, reduction);
+            if (i == 0) {
+                score = -_search(position, node.depth - 1, ply + 1, -node.beta, -node.alpha);
+            } else {
+                score = -_search(position, node.depth - 1 - reduction, ply + 1, -node.alpha - 1, -node.alpha);
+                if (score > node.alpha && reduction > 0) {
+                    score = -_search(position, node.depth - 1, ply + 1, -node.alpha - 1, -node.alpha);
+                }
+                if (score > node.alpha && score < node.beta) {
+                    score = -_search(position, node.depth - 1, ply + 1, -node.beta, -node.alpha);
+                }
+            }
+            if (_undoMove(position, node, move, i, score)) {
+                break;
+            }
+        }
+        return _leave(node);
+    }
+
+    // what a node carries from one stage to the next
+    struct Node
+    {
+        int         depth = 0;
+        int         ply = 0;
+        int         alpha = 0;
+        int         beta = 0;
+        int         originalAlpha = 0;
+        bool        pvNode = false;
+        bool        onPv = false;           // still on last depth's best line
+        bool        haveTableMove = false;
+        uint16_t    tableMove = 0;
+        uint64_t    key = 0;
+        int         best = 0;
+        Move        bestMove{};
+    };
+
+    // everything a node does before it needs its moves, true with score set if that settles it
+    bool _enter(Position &position, Node &node, int depth, int ply, int alpha, int beta, int &score)
+    {
+        Derived &derived = _derived();
+        node.pvNode = beta - alpha > 1;
+        node.ply = ply;
+        _pvLength[ply] = 0;
+        if (ply > 0) {
+            if (_checkStop()) {
+                score = 0;
+                return true;
+            }
+            if (derived.isTerminal(position, ply, score)) {
+                return true;
+            }
+            // no line from here can beat a win we've already found closer to the root
+            int lost = -(SEARCH_WIN_SCORE - ply);
+            if (alpha < lost) alpha = lost;
+            if (beta > -lost - 1) beta = -lost - 1;
+            if (alpha >= beta) {
+                score = alpha;
+                return true;
+            }
+        }
+        if (ply >= SEARCH_MAX_PLY - 1) {
+            score = position.eval();
+            return true;
+        }
+        depth += derived.extension(position, ply);
+        if (depth <= 0) {
+            score = derived.leafScore(position, ply, alpha, beta);
+            return true;
+        }
+        _stats.nodes++;
+        node.depth = depth;
+        node.alpha = alpha;
+        node.beta = beta;
+
+        // a deep enough result from before can stand in for this whole subtree
+        if (_table->enabled()) {
+            node.key = position.hash();
+            _stats.ttProbes++;
+            TableEntry entry;
+            if (_table->probe(node.key, entry)) {
+                _stats.ttHits++;
+                node.haveTableMove = true;
+                node.tableMove = entry.move;
+                score = _scoreFromTable(entry.score, ply);
+                if (!node.pvNode && entry.depth >= depth &&
+                    (entry.bound == BOUND_EXACT ||
+                     (entry.bound == BOUND_LOWER && score >= beta) ||
+                     (entry.bound == BOUND_UPPER && score <= alpha))) {
+                    _stats.ttCutoffs++;
+                    return true;
+                }
+            }
+        }
+        return derived.prune(position, depth, ply, alpha, beta, score);
+    }
+
+    // plies less to search a pass with, with the pass played, or 0 with nothing played if the node doesn't try one
+    int _playNull(Position &position, const Node &node, bool nullMove)
+    {
+        int reduction = _derived().nullMoveReduction(position, node.depth, node.ply, node.alpha, node.beta, nullMove);
+        if (reduction > 0) {
+            _derived().playNull(position);
+        }
+        return reduction;
+    }
+
+    // takes the pass back, true with score set if passing was still good enough
+    bool _undoNull(Position &position, const Node &node, int nullScore, int &score)
+    {
+        _derived().undoNull(position);
+        if (_stopped) {
+            score = 0;
+            return true;
+        }
+        if (nullScore >= node.beta) {
+            // a win found by passing can't be trusted to be one
+            score = isWinScore(nullScore) ? node.beta : nullScore;
+            return true;
+        }
+        return false;
+    }
+
+    // generates and orders the moves, true with score set if there are none
+    bool _expand(Position &position, Node &node, Moves &moves, int &score)
+    {
+        Derived &derived = _derived();
+        int ply = node.ply;
+        position.moves(moves);
+        if (moves.empty()) {
+            score = derived.noMovesScore(position, ply);
+            return true;
+        }
+        _stats.interiorNodes++;
+        // the table's best move goes first, unless we're still on last depth's best line
+        node.onPv = Derived::FOLLOW_PV && _followPv && ply < _hintLength;
+        const Move *first = node.onPv ? &_hint[ply] : nullptr;
+        Move tableMove{};
+        if (!node.onPv && node.haveTableMove) {
+            for (int i = 0; i < moves.size(); i++) {
+                if (moveCode(moves[i]) == node.tableMove) {
+                    tableMove = moves[i];
+                    first = &tableMove;
+                    break;
+                }
+            }
+        }
+        derived.orderMoves(position, moves, first, ply);
+        node.originalAlpha = node.alpha;
+        node.best = -SEARCH_INFINITY;
+        node.bestMove = moves[0];
+        return false;
+    }
+
+    // plays moves[index] and returns it, reduction is how much shallower to try it first
+    Move _playMove(Position &position, Node &node, Moves &moves, int index, int &reduction)
+    {
+        _derived().pickMove(moves, index, node.ply);
+        const Move move = moves[index];
+        _followPv = node.onPv && index == 0 && move == _hint[node.ply];
+        _stats.movesSearched++;
+
+        position.play(move);
+        // the child probes the table first thing, get its line on the way while the checks before that run
+        if (node.depth > 1 && _table->enabled()) {
+            _table->prefetch(position.hash());
+        }
+        reduction = index > 0 ? _derived().reduction(position, move, node.depth, index, node.pvNode, node.ply) : 0;
+        return move;
+    }
+
+    // takes move back with the score it got, true once no more moves need searching
+    bool _undoMove(Position &position, Node &node, const Move &move, int index, int score)
+    {
+        position.undo(move);
+        if (_stopped) {
+            return true;
+        }
+        if (score > node.best) {
+            node.best = score;
+            node.bestMove = move;
+            if (score > node.alpha) {
+                node.alpha = score;
+                // this move plus the line below it is the new principal variation
+                int ply = node.ply;
+                _pv[ply][0] = move;
+                for (int j = 0; j < _pvLength[ply + 1]; j++) {
+                    _pv[ply][j + 1] = _pv[ply + 1][j];
+                }
+                _pvLength[ply] = _pvLength[ply + 1] + 1;
+                if (node.alpha >= node.beta) {
+                    _stats.cutoffs++;
+                    if (index == 0) {
+                        _stats.firstMoveCutoffs++;
+                    }
+                    _derived().onCutoff(position, move, node.depth, ply);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // the node's score, kept in the table for next time
+    int _leave(const Node &node)
+    {
+        if (_stopped) {
+            return 0;
+        }
+        if (_table->enabled()) {
+            _table->store(node.key, moveCode(node.bestMove), _scoreToTable(node.best, node.ply), node.depth,
+                         node.best >= node.beta ? BOUND_LOWER : (node.best > node.originalAlpha ? BOUND_EXACT : BOUND_UPPER));
+        }
+        return node.best;
+    }
+
+    SearchLimits    _limits;
+    std::chrono::steady_clock::time_point _start;
+    bool            _stopped = false;
+    SearchStats     _stats;
+    Table           _ownTable;
+    Table           *_table = &_ownTable;
+    Move            _pv[SEARCH_MAX_PLY][SEARCH_MAX_PLY];
+    int             _pvLength[SEARCH_MAX_PLY] = {};
+    Move            _hint[SEARCH_MAX_PLY];
+    int             _hintLength = 0;
+    bool            _followPv = false;
+};
+
+//
+// the search as it comes, for games that need nothing more
+//
+template <class Position>
+class Searcher : public AlphaBeta<Searcher<Position>, Position>
+{
+public:
+    // megabytes of transposition table
+    static const size_t DEFAULT_TABLE_MEGABYTES = 2;
+
+    Searcher(size_t tableMegabytes = DEFAULT_TABLE_MEGABYTES) : AlphaBeta<Searcher<Position>, Position>(tableMegabytes) {}
+};
+
+//
+// the searcher a game's AI uses, games with a search of their own specialise this
+//
+template <class Position>
+struct SearcherFor
+{
+    typedef Searcher<Position> Type;
+};
+
+//
+// pick the best move for the side to move, returns false if there is nothing to play
+//
+template <class Position>
+bool searchBestMove(Position &position, int depth, typename Position::Move &bestMove, int *bestScore = nullptr)
+{
+    SearchLimits limits;
+    limits.depth = depth;
+    Searcher<Position> searcher;
+    SearchResult<Position> result = searcher.search(position, limits);
+    if (!result.found) {
+        return false;
+    }
+    bestMove = result.bestMove;
+    if (bestScore) {
+        *bestScore = result.score;
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// what one search cost, filled in by Searcher as it goes and kept until the next search starts
+// plain numbers and strings so the game window can show it without knowing which game it is
+//
+struct SearchIteration
+{
+    int         depth;
+    int         score;
+    uint64_t    nodes;          // nodes this depth took on its own
+    int64_t     microseconds;   // time this depth took on its own
+};
+
+struct SearchStats
+{
+    uint64_t    nodes = 0;
+    uint64_t    interiorNodes = 0;      // nodes that generated moves
+    uint64_t    movesSearched = 0;      // children searched below interior nodes
+    uint64_t    cutoffs = 0;            // beta cutoffs
+    uint64_t    firstMoveCutoffs = 0;   // cutoffs on the first move tried, how good move ordering is
+    uint64_t    ttProbes = 0;
+    uint64_t    ttHits = 0;
+    uint64_t    ttCutoffs = 0;          // hits good enough to skip the search below
+    int         tableFill = 0;          // per thousand of the table holding entries from this search
+    size_t      tableBytes = 0;
+    int         depth = 0;
+    int         score = 0;
+    int64_t     microseconds = 0;
+    std::string pv;                     // best line, moves written the way the game writes them
+    std::vector<SearchIteration> iterations;
+    // monte carlo searches fill these instead of the alpha-beta numbers, depth is how deep the tree got
+    // and score the best move's win rate in percent
+    uint64_t    playouts = 0;
+    uint64_t    reusedPlayouts = 0;     // already in the tree from earlier moves
+    uint64_t    treeNodes = 0;
+
+    void reset() { *this = SearchStats(); }
+
+    double nodesPerSecond() const { return microseconds > 0 ? nodes * 1e6 / microseconds : 0.0; }
+    double playoutsPerSecond() const { return microseconds > 0 ? playouts * 1e6 / microseconds : 0.0; }
+    double ttHitRate() const { return ttProbes ? (double)ttHits / ttProbes : 0.0; }
+    double firstMoveCutoffRate() const { return cutoffs ? (double)firstMoveCutoffs / cutoffs : 0.0; }
+    // children actually searched per interior node, alpha-beta keeps this well under the move count
+    double averageBranching() const { return interiorNodes ? (double)movesSearched / interiorNodes : 0.0; }
+    // how many times more nodes the last depth took than the one before
+    double effectiveBranching() const
+    {
+        size_t count = iterations.size();
+        if (count < 2 || iterations[count - 2].nodes == 0) {
+            return 0.0;
+        }
+        return (double)iterations[count - 1].nodes / iterations[count - 2].nodes;
+    }
+};
@@ -0,0 +1,180 @@
+#pragma once
+#include "Coroutine.h"
+#include "Search.h"
+#include <cstdint>
+#include <vector>
+
+//
+// a game's own searcher, spread over frames so it can run a few milliseconds at a time on the render thread
+// it runs the same stages and hooks as search() does, only the recursion between them is coroutines instead of calls,
+// so a search comes out with the same move, score and node count however it was sliced
+// every level of the recursion is a Task that awaits the one below, when a slice runs out the innermost one
+// suspends and the whole line of them waits where it is, nothing unwinds, the next resume() carries on from there
+// nodes settled before their moves are needed, leaves most of all, are done without a coroutine of their own
+// search() still searches in one go, not while a sliced search is running, and multiPv is only searched that way
+//
+template <class Position, class GameSearcher = typename SearcherFor<Position>::Type>
+class SlicedSearcher : public GameSearcher
+{
+public:
+    typedef typename Position::Move Move;
+    typedef typename Position::Moves Moves;
+    typedef SearchResult<Position> Result;
+
+    static const size_t DEFAULT_TABLE_MEGABYTES = GameSearcher::DEFAULT_TABLE_MEGABYTES;
+    // a quarter of a 60 fps frame
+    static const int64_t DEFAULT_SLICE_MICROSECONDS = 4000;
+
+    SlicedSearcher(size_t tableMegabytes = DEFAULT_TABLE_MEGABYTES) : GameSearcher(tableMegabytes) {}
+
+    // set up a search of position, nothing runs until the first resume(), a search still going is dropped
+    // limits.movetime counts from here, frames spent drawing included
+    void start(const Position &position, const SearchLimits &limits)
+    {
+        cancel();
+        _position = position;
+        this->_start = std::chrono::steady_clock::now();
+        _nextCheck = 0;
+        _result = Result();
+        if (this->_startSearch(_position, limits, _result)) {
+            _task = _iterate();
+            _suspended = _task.handle();
+        }
+    }
+
+    // search for about microseconds more, true once it has finished and result() holds the move
+    bool resume(int64_t microseconds)
+    {
+        if (!_task) {
+            return true;
+        }
+        TraceScope sliceScope("slice", "search", "depth", _result.depth + 1);
+        _sliceEnd = this->_elapsedMicroseconds() + microseconds;
+        std::coroutine_handle<> next = _suspended;
+        _suspended = nullptr;
+        next.resume();
+        if (!_task.done()) {
+            return false;
+        }
+        _task = Task<int>();
+        this->_finishSearch(_result);
+        return true;
+    }
+
+    // drops the search, the suspended frames go with it
+    void cancel()
+    {
+        _task = Task<int>();
+        _suspended = nullptr;
+    }
+
+    bool running() const { return (bool)_task; }
+    const Result &result() const { return _result; }
+
+private:
+    typedef typename GameSearcher::Node Node;
+
+    static const uint64_t CHECK_NODES = 256;
+
+    // suspends the coroutine that awaits it and hands control back to resume()'s caller
+    struct Suspend
+    {
+        SlicedSearcher *searcher;
+
+        bool await_ready() const { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { searcher->_suspended = handle; }
+        void await_resume() const {}
+    };
+
+    // search()'s deepening loop
+    Task<int> _iterate()
+    {
+        int score = 0;
+        for (int depth = 1; depth <= this->_maxDepth(); depth++) {
+            uint64_t nodesBefore = this->_stats.nodes;
+            int64_t startedAt = this->_elapsedMicroseconds();
+            this->_followPv = true;
+            int alpha, beta;
+            this->_rootWindow(depth, score, alpha, beta);
+            do {
+                score = co_await _child(depth, 0, alpha, beta, false);
+            } while (this->_widenRoot(score, alpha, beta));
+            if (!this->_finishDepth(_position, depth, score, nodesBefore, startedAt, std::vector<typename Result::Line>(), _result,
+                                    nullptr)) {
+                break;
+            }
+        }
+        co_return _result.score;
+    }
+
+    // a child node to co_await, settled on the spot when it can be, otherwise searched in a coroutine of its own
+    struct Child
+    {
+        int         score = 0;
+        Task<int>   task;   // empty when settled
+
+        bool await_ready() const { return !task; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) { return task.await_suspend(awaiting); }
+        int await_resume() const { return task ? task.await_resume() : score; }
+    };
+
+    Child _child(int depth, int ply, int alpha, int beta, bool nullMove)
+    {
+        Child child;
+        Node node;
+        if (!this->_enter(_position, node, depth, ply, alpha, beta, child.score)) {
+            child.task = _search(node, nullMove);
+        }
+        return child;
+    }
+
+    // AlphaBeta::_search from its first stage on, with the slice's end looked for on the way in
+    Task<int> _search(Node node, bool nullMove)
+    {
+        // the clock is only worth reading every few hundred nodes, leaves count without looking so go by a threshold
+        if (this->_stats.nodes >= _nextCheck) {
+            _nextCheck = this->_stats.nodes + CHECK_NODES;
+            if (this->_elapsedMicroseconds() >= _sliceEnd) {
+                co_await Suspend{ this };
+            }
+        }
+        int ply = node.ply;
+        int score;
+        if (int reduction = this->_playNull(_position, node, nullMove)) {
+            int nullScore = -(co_await _child(node.depth - 1 - reduction, ply + 1, -node.beta, -node.beta + 1, true));
+            if (this->_undoNull(_position, node, nullScore, score)) {
+                co_return score;
+            }
+        }
+        Moves moves;
+        if (this->_expand(_position, node, moves, score)) {
+            co_return score;
+        }
+        for (int i = 0; i < moves.size(); i++) {
+            int reduction;
+            const Move move = this->_playMove(_position, node, moves, i, reduction);
+            if (i == 0) {
+                score = -(co_await _child(node.depth - 1, ply + 1, -node.beta, -node.alpha, false));
+            } else {
+                score = -(co_await _child(node.depth - 1 - reduction, ply + 1, -node.alpha - 1, -node.alpha, false));
+                if (score > node.alpha && reduction > 0) {
+                    score = -(co_await _child(node.depth - 1, ply + 1, -node.alpha - 1, -node.alpha, false));
+                }
+                if (score > node.alpha && score < node.beta) {
+                    score = -(co_await _child(node.depth - 1, ply + 1, -node.beta, -node.alpha, false));
+                }
+            }
+            if (this->_undoMove(_position, node, move, i, score)) {
+                break;
+            }
+        }
+        co_return this->_leave(node);
+    }
+
+    Position        _position;
+    int64_t         _sliceEnd = 0;      // microseconds since start
+    uint64_t        _nextCheck = 0;     // node count to look at the clock again at
+    Task<int>       _task;
+    std::coroutine_handle<> _suspended;
+    Result          _result;
+};
@@ -0,0 +1,127 @@
+#include "TicTacToePosition.h"
+#include "BitOps.h"
+
+static const uint16_t kWinningTriples[8] = {
+    0007, 0070, 0700,   // rows
+    0111, 0222, 0444,   // cols
+    0421, 0124          // diagonals
+};
+
+TicTacToePosition::TicTacToePosition()
+{
+    reset();
+}
+
+void TicTacToePosition::reset()
+{
+    _squares[0] = _squares[1] = 0;
+    _plies = 0;
+    _winner = -1;
+}
+
+bool TicTacToePosition::_hasThree(uint16_t squares)
+{
+    for (uint16_t triple : kWinningTriples) {
+        if ((squares & triple) == triple) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TicTacToePosition::canPlay(int square) const
+{
+    return square >= 0 && square < 9 && !gameOver() && pieceAt(square) < 0;
+}
+
+void TicTacToePosition::moves(Moves &list) const
+{
+    list.clear();
+    if (gameOver()) {
+        return;
+    }
+    uint16_t empty = ~(_squares[0] | _squares[1]) & 0777;
+    while (empty) {
+        int square = lowestBit(empty);
+        list.push(square);
+        empty &= empty - 1;
+    }
+}
+
+void TicTacToePosition::play(Move square)
+{
+    int side = sideToMove();
+    _squares[side] |= 1 << square;
+    _plies++;
+    if (_hasThree(_squares[side])) {
+        _winner = side;
+    }
+}
+
+void TicTacToePosition::undo(Move square)
+{
+    _plies--;
+    _squares[sideToMove()] &= ~(1 << square);
+    _winner = -1;
+}
+
+uint64_t TicTacToePosition::hash() const
+{
+    return mixHash(((uint64_t)_squares[1] << 16) | _squares[0]);
+}
+
+int TicTacToePosition::pieceAt(int square) const
+{
+    if (_squares[0] & (1 << square)) return 0;
+    if (_squares[1] & (1 << square)) return 1;
+    return -1;
+}
+
+std::string TicTacToePosition::stateString() const
+{
+    std::string state(9, '0');
+    for (int square = 0; square < 9; square++) {
+        state[square] = (char)('1' + pieceAt(square));
+    }
+    return state;
+}
+
+bool TicTacToePosition::setStateString(const std::string &s)
+{
+    if (s.length() != 9) {
+        return false;
+    }
+    uint16_t squares[2] = { 0, 0 };
+    for (int square = 0; square < 9; square++) {
+        if (s[square] == '1') {
+            squares[0] |= 1 << square;
+        } else if (s[square] == '2') {
+            squares[1] |= 1 << square;
+        } else if (s[square] != '0') {
+            return false;
+        }
+    }
+    int counts[2] = { popCount(squares[0]), popCount(squares[1]) };
+    if (counts[0] != counts[1] && counts[0] != counts[1] + 1) {
+        return false;
+    }
+    _squares[0] = squares[0];
+    _squares[1] = squares[1];
+    _plies = counts[0] + counts[1];
+    _winner = _hasThree(squares[0]) ? 0 : (_hasThree(squares[1]) ? 1 : -1);
+    return true;
+}
+
+std::string TicTacToePosition::moveToString(Move square) const
+{
+    return std::string(1, (char)('1' + square));
+}
+
+bool TicTacToePosition::parseMove(const std::string &text, Move &square) const
+{
+    if (text.length() != 1 || text[0] < '1' || text[0] > '9') {
+        return false;
+    }
+    square = text[0] - '1';
+    return canPlay(square);
+}
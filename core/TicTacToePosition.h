@@ -0,0 +1,51 @@
+#pragma once
+#include "MoveList.h"
+#include <cstdint>
+#include <string>
+
+//
+// tic tac toe rules with a 9 bit mask per player, no rendering
+// squares are numbered 0 to 8 left to right, top row first, player 0 moves first
+//
+class TicTacToePosition
+{
+public:
+    typedef int Move;   // the square to mark
+    typedef MoveList<Move, 9> Moves;
+
+    TicTacToePosition();
+
+    void        reset();
+
+    void        moves(Moves &list) const;
+    bool        canPlay(int square) const;
+    void        play(Move square);
+    void        undo(Move square);
+
+    int         sideToMove() const { return _plies & 1; }
+    int         plies() const { return _plies; }
+    bool        gameOver() const { return _winner >= 0 || _plies == 9; }
+    // player with three in a row, -1 if nobody has
+    int         winner() const { return _winner; }
+    // nothing to weigh up short of a finished game
+    int         eval() const { return 0; }
+    uint64_t    hash() const;
+
+    // -1 for an empty square, otherwise the player number
+    int         pieceAt(int square) const;
+
+    // '0' empty, '1' player 0, '2' player 1
+    std::string stateString() const;
+    bool        setStateString(const std::string &s);
+
+    // squares are written 1 to 9
+    std::string moveToString(Move square) const;
+    bool        parseMove(const std::string &text, Move &square) const;
+
+private:
+    static bool _hasThree(uint16_t squares);
+
+    uint16_t    _squares[2];
+    int         _plies;
+    int         _winner;
+};
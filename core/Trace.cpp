@@ -0,0 +1,169 @@
+#include "Trace.h"
+#include <chrono>
+#include <cstdio>
+
+Tracer &Tracer::shared()
+{
+    // never destroyed, threads still running at exit may record into it
+    static Tracer *tracer = new Tracer();
+    return *tracer;
+}
+
+Tracer::Tracer() : _enabled(false)
+{
+    _epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t Tracer::_now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() - _epoch;
+}
+
+void Tracer::setEnabled(bool enabled)
+{
+    if (enabled && !isEnabled()) {
+        std::lock_guard<std::mutex> lock(_buffersMutex);
+        for (ThreadBuffer *buffer : _buffers) {
+            buffer->skipped = buffer->recorded.load(std::memory_order_acquire);
+        }
+    }
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+//
+// the calling thread's buffer, made the first time it records
+// buffers outlive their threads so a finished worker's events still get written
+//
+Tracer::ThreadBuffer *Tracer::_buffer()
+{
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (!buffer) {
+        buffer = new ThreadBuffer();
+        buffer->first = buffer->last = new Chunk();
+        buffer->chunks = 1;
+        std::lock_guard<std::mutex> lock(_buffersMutex);
+        buffer->id = (int)_buffers.size() + 1;
+        _buffers.push_back(buffer);
+    }
+    return buffer;
+}
+
+void Tracer::_record(char phase, const char *name, const char *category, const char *argName, int64_t argValue)
+{
+    ThreadBuffer *buffer = _buffer();
+    Chunk *chunk = buffer->last;
+    int index = chunk->count.load(std::memory_order_relaxed);
+    if (index == CHUNK_EVENTS) {
+        if (buffer->chunks == MAX_CHUNKS) {
+            return;
+        }
+        Chunk *next = new Chunk();
+        chunk->next.store(next, std::memory_order_release);
+        buffer->last = chunk = next;
+        buffer->chunks++;
+        index = 0;
+    }
+    chunk->events[index] = { name, category, argName, argValue, _now(), phase };
+    // the reader only looks at events below count, so the event is complete before it's visible
+    chunk->count.store(index + 1, std::memory_order_release);
+    buffer->recorded.fetch_add(1, std::memory_order_release);
+}
+
+void Tracer::begin(const char *name, const char *category, const char *argName, int64_t argValue)
+{
+    if (isEnabled()) {
+        _record('B', name, category, argName, argValue);
+    }
+}
+
+void Tracer::end(const char *name, const char *category)
+{
+    // not checked against isEnabled, a begin that made it in gets its end
+    _record('E', name, category, nullptr, 0);
+}
+
+void Tracer::instant(const char *name, const char *category)
+{
+    if (isEnabled()) {
+        _record('i', name, category, nullptr, 0);
+    }
+}
+
+void Tracer::setThreadName(const std::string &name)
+{
+    ThreadBuffer *buffer = _buffer();
+    std::lock_guard<std::mutex> lock(buffer->nameMutex);
+    buffer->name = name;
+}
+
+uint64_t Tracer::eventCount()
+{
+    std::lock_guard<std::mutex> lock(_buffersMutex);
+    uint64_t count = 0;
+    for (ThreadBuffer *buffer : _buffers) {
+        count += buffer->recorded.load(std::memory_order_acquire) - buffer->skipped;
+    }
+    return count;
+}
+
+static std::string jsonEscaped(const std::string &text)
+{
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+bool Tracer::writeJson(const std::string &path)
+{
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) {
+            fprintf(file, ",\n");
+        }
+        first = false;
+    };
+
+    std::lock_guard<std::mutex> lock(_buffersMutex);
+    for (ThreadBuffer *buffer : _buffers) {
+        {
+            std::lock_guard<std::mutex> nameLock(buffer->nameMutex);
+            if (!buffer->name.empty()) {
+                separator();
+                fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                        buffer->id, jsonEscaped(buffer->name).c_str());
+            }
+        }
+        uint64_t index = 0;
+        for (Chunk *chunk = buffer->first; chunk; chunk = chunk->next.load(std::memory_order_acquire)) {
+            int count = chunk->count.load(std::memory_order_acquire);
+            for (int i = 0; i < count; i++, index++) {
+                if (index < buffer->skipped) {
+                    continue;
+                }
+                const Event &event = chunk->events[i];
+                separator();
+                fprintf(file, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d",
+                        event.name, event.category, event.phase, event.nanoseconds / 1000.0, buffer->id);
+                if (event.phase == 'i') {
+                    fprintf(file, ",\"s\":\"t\"");
+                }
+                if (event.argName) {
+                    fprintf(file, ",\"args\":{\"%s\":%lld}", event.argName, (long long)event.argValue);
+                }
+                fprintf(file, "}");
+            }
+        }
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//
+// begin/end events for offline timelines, written out as chrome trace_event json that opens in perfetto
+// every thread records into its own buffer, recording never takes a lock or waits on another thread
+// event names and categories must be string literals, only the pointer is kept
+//
+class Tracer
+{
+public:
+    static Tracer &shared();
+
+    bool    isEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+    // starting again drops everything recorded before
+    void    setEnabled(bool enabled);
+
+    void    begin(const char *name, const char *category, const char *argName = nullptr, int64_t argValue = 0);
+    void    end(const char *name, const char *category);
+    void    instant(const char *name, const char *category);
+    // shows up as the thread's name in the timeline, name is copied
+    void    setThreadName(const std::string &name);
+
+    // everything recorded since tracing was turned on, safe while other threads keep recording
+    bool    writeJson(const std::string &path);
+    uint64_t eventCount();
+
+private:
+    struct Event
+    {
+        const char  *name;
+        const char  *category;
+        const char  *argName;
+        int64_t     argValue;
+        int64_t     nanoseconds;
+        char        phase;
+    };
+
+    static const int CHUNK_EVENTS = 4096;
+    // a runaway thread stops recording instead of eating all memory, about 40 MB each
+    static const int MAX_CHUNKS = 256;
+
+    // events are appended by the owning thread, count is published after the event is written
+    struct Chunk
+    {
+        Event               events[CHUNK_EVENTS];
+        std::atomic<int>    count{0};
+        std::atomic<Chunk*> next{nullptr};
+    };
+
+    struct ThreadBuffer
+    {
+        int                 id;
+        Chunk               *first;
+        Chunk               *last;          // only the owning thread touches this
+        int                 chunks;
+        std::atomic<uint64_t> recorded{0};  // total events ever written
+        uint64_t            skipped = 0;    // events from before the last restart, reader side only
+        std::mutex          nameMutex;      // names are rare, a lock here costs nothing
+        std::string         name;
+    };
+
+    Tracer();
+
+    ThreadBuffer    *_buffer();
+    void            _record(char phase, const char *name, const char *category, const char *argName, int64_t argValue);
+    int64_t         _now() const;
+
+    std::atomic<bool>           _enabled;
+    int64_t                     _epoch;
+    std::mutex                  _buffersMutex;  // only taken when a thread first records and when writing out
+    std::vector<ThreadBuffer*>  _buffers;
+};
+
+//
+// a begin event now and the matching end when the block closes
+//
+class TraceScope
+{
+public:
+    TraceScope(const char *name, const char *category, const char *argName = nullptr, int64_t argValue = 0)
+        : _name(name), _category(category), _active(Tracer::shared().isEnabled())
+    {
+        if (_active) {
+            Tracer::shared().begin(name, category, argName, argValue);
+        }
+    }
+
+    // the end goes in even if tracing was turned off meanwhile, so every begin is closed
+    ~TraceScope()
+    {
+        if (_active) {
+            Tracer::shared().end(_name, _category);
+        }
+    }
+
+private:
+    const char  *_name;
+    const char  *_category;
+    bool        _active;
+};
@@ -0,0 +1,104 @@
+#include "TranspositionTable.h"
+#include <cstdlib>
+#include <new>
+#if defined(_WIN32)
+#include <malloc.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// transparent huge pages come in 2MB, a table has to start on one to use them
+static const size_t kHugePageBytes = 2 * 1024 * 1024;
+
+TranspositionTable::~TranspositionTable()
+{
+    _release();
+}
+
+void TranspositionTable::resize(size_t megabytes, bool hugePages)
+{
+    _release();
+    size_t buckets = megabytes * 1024 * 1024 / sizeof(Bucket);
+    if (buckets == 0) {
+        return;
+    }
+    size_t count = 1;
+    while (count * 2 <= buckets) {
+        count *= 2;
+    }
+    size_t bytes = count * sizeof(Bucket);
+
+    void *memory = nullptr;
+#if defined(_WIN32)
+    // large pages on windows need a privilege most accounts don't have, not worth asking for
+    memory = _aligned_malloc(bytes, alignof(Bucket));
+#else
+    size_t alignment = alignof(Bucket);
+#if defined(__linux__)
+    if (hugePages && bytes >= kHugePageBytes) {
+        alignment = kHugePageBytes;
+    }
+#endif
+    if (posix_memalign(&memory, alignment, bytes) != 0) {
+        memory = nullptr;
+    }
+#if defined(__linux__)
+    // only a hint, the kernel backs what it can with huge pages and the rest with normal ones
+    _hugePages = memory && alignment == kHugePageBytes && madvise(memory, bytes, MADV_HUGEPAGE) == 0;
+#endif
+#endif
+    if (!memory) {
+        _hugePages = false;
+        return;
+    }
+    _buckets = static_cast<Bucket *>(memory);
+    _bucketCount = count;
+    for (size_t i = 0; i < count; i++) {
+        new (&_buckets[i]) Bucket();
+    }
+}
+
+void TranspositionTable::clear()
+{
+    for (size_t i = 0; i < _bucketCount; i++) {
+        for (Slot &slot : _buckets[i].slots) {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    _generation.store(0, std::memory_order_relaxed);
+}
+
+int TranspositionTable::fillPerMille() const
+{
+    size_t buckets = _bucketCount < 1000 ? _bucketCount : 1000;
+    if (buckets == 0) {
+        return 0;
+    }
+    int generation = _generation.load(std::memory_order_relaxed);
+    size_t used = 0;
+    for (size_t i = 0; i < buckets; i++) {
+        for (const Slot &slot : _buckets[i].slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if (data != 0 && _generationOf(data) == generation) {
+                used++;
+            }
+        }
+    }
+    return (int)(used * 1000 / (buckets * SLOTS));
+}
+
+void TranspositionTable::_release()
+{
+    if (!_buckets) {
+        return;
+    }
+#if defined(_WIN32)
+    _aligned_free(_buckets);
+#else
+    free(_buckets);
+#endif
+    _buckets = nullptr;
+    _bucketCount = 0;
+    _hugePages = false;
+}
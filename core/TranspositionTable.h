@@ -0,0 +1,133 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//
+// what a transposition table keeps for a position
+// moves go in as a 16 bit code from moveCode(), the searcher matches it back to one of the position's moves
+//
+enum TableBound : uint8_t { BOUND_NONE, BOUND_EXACT, BOUND_LOWER, BOUND_UPPER };
+
+struct TableEntry
+{
+    uint16_t    move = 0;
+    int32_t     score = 0;
+    int         depth = 0;
+    TableBound  bound = BOUND_NONE;
+};
+
+//
+// the table every searcher uses, sized in megabytes
+// buckets are one cache line of four slots, a probe reads one line and a store replaces whichever slot is worth least,
+// shallow results and ones left over from earlier searches go first
+// each slot is two words, the entry packed into one and the key xor'd with it in the other, threads read and write
+// them without locks and a slot caught halfway through a write just fails to match, so searches on several threads
+// can share one table
+//
+class TranspositionTable
+{
+public:
+    static const int SLOTS = 4;
+
+    TranspositionTable() {}
+    ~TranspositionTable();
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+    // megabytes rounded down to a power of two buckets, 0 turns the table off
+    // hugePages asks the system for 2MB pages, fewer TLB misses on big tables, the table still works if it says no
+    void        resize(size_t megabytes, bool hugePages = false);
+    void        clear();
+    bool        enabled() const { return _buckets != nullptr; }
+    size_t      bytes() const { return _bucketCount * sizeof(Bucket); }
+    bool        hugePages() const { return _hugePages; }
+
+    // a search starting, anything stored before this is older and goes first when space is needed
+    void        newSearch() { _generation.store((_generation.load(std::memory_order_relaxed) + 1) & GENERATION_MASK, std::memory_order_relaxed); }
+
+    // copies out what's stored for key, false if no slot holds it
+    bool probe(uint64_t key, TableEntry &entry) const
+    {
+        const Bucket &bucket = _bucket(key);
+        for (const Slot &slot : bucket.slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if (data != 0 && (slot.check.load(std::memory_order_relaxed) ^ data) == key) {
+                entry.score = (int32_t)(uint32_t)data;
+                entry.move = (uint16_t)(data >> 32);
+                entry.depth = (int8_t)(data >> 48);
+                entry.bound = (TableBound)((data >> 56) & 3);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store(uint64_t key, uint16_t move, int score, int depth, TableBound bound)
+    {
+        Bucket &bucket = _bucket(key);
+        int generation = _generation.load(std::memory_order_relaxed);
+        Slot *victim = &bucket.slots[0];
+        int victimWorth = 1 << 30;
+        for (Slot &slot : bucket.slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if (data != 0 && (slot.check.load(std::memory_order_relaxed) ^ data) == key) {
+                // a shallower look at the same position from this search only gets in if it's exact
+                if (depth < (int8_t)(data >> 48) && bound != BOUND_EXACT && _generationOf(data) == generation) {
+                    return;
+                }
+                victim = &slot;
+                break;
+            }
+            // empty slots first, then shallow ones, each search since it was stored counts as a lot of depth
+            int worth = data == 0 ? -(1 << 30) : (int8_t)(data >> 48) - 8 * ((generation - _generationOf(data)) & GENERATION_MASK);
+            if (worth < victimWorth) {
+                victim = &slot;
+                victimWorth = worth;
+            }
+        }
+        uint64_t data = (uint64_t)(uint32_t)score | (uint64_t)move << 32 | (uint64_t)(uint8_t)depth << 48 |
+                        (uint64_t)bound << 56 | (uint64_t)generation << 58;
+        victim->check.store(key ^ data, std::memory_order_relaxed);
+        victim->data.store(data, std::memory_order_relaxed);
+    }
+
+    // start fetching key's bucket, worth it a little before the probe when the table is bigger than the cache
+    void prefetch(uint64_t key) const
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(&_bucket(key));
+#else
+        (void)key;
+#endif
+    }
+
+    // slots holding entries from the current search per thousand, sampled from the first thousand buckets
+    int         fillPerMille() const;
+
+private:
+    static const int GENERATION_MASK = 63;
+
+    struct Slot
+    {
+        std::atomic<uint64_t>   check{ 0 };    // key ^ data
+        std::atomic<uint64_t>   data{ 0 };     // score 32 bits, move 16, depth 8, bound 2, generation 6
+    };
+
+    struct alignas(64) Bucket
+    {
+        Slot    slots[SLOTS];
+    };
+
+    static int _generationOf(uint64_t data) { return (int)(data >> 58); }
+
+    const Bucket &_bucket(uint64_t key) const { return _buckets[key & (_bucketCount - 1)]; }
+    Bucket &_bucket(uint64_t key) { return _buckets[key & (_bucketCount - 1)]; }
+
+    void        _release();
+
+    Bucket                  *_buckets = nullptr;
+    size_t                  _bucketCount = 0;
+    bool                    _hugePages = false;
+    std::atomic<int>        _generation{ 0 };
+};
@@ -0,0 +1,347 @@
+//
+// batch analysis of a file of positions, for going through the positions pulled out of logs
+// one state string per line, the same text stateString() writes and the engine's "position state" takes,
+// optionally followed by " side 1" or " side 2" for boards that can't tell whose turn it is,
+// blank lines and lines starting with # are skipped
+//
+//   analyse <game> <file> [options]
+//     --depth <plies>       search each position this deep (default 8)
+//     --movetime <ms>       or for this long, as deep as the time allows
+//     --threads <n>         positions searched at once (default one per core)
+//     --hash <mb>           transposition table per worker (default the game searcher's own)
+//     --json                one json object per position instead of csv
+//     --output <file>       write results here instead of stdout
+//
+// each worker keeps its own searcher and table from one position to the next, positions from the same
+// game share a lot of their trees, results come out in the order the positions went in as soon as
+// everything before them is done, and the throughput goes to stderr at the end
+// file can be - to read from stdin
+//
+#include "core/Connect4Position.h"
+#include "core/OthelloPosition.h"
+#include "core/CheckersPosition.h"
+#include "core/TicTacToePosition.h"
+#include "core/ChessSearch.h"
+#include "core/Search.h"
+#include "core/Scheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct AnalyseOptions
+{
+    std::string     game;
+    std::string     inputPath;
+    std::string     outputPath;
+    int             depth = 8;
+    int64_t         movetime = 0;
+    int             threads = 0;
+    size_t          hashMegabytes = 0;      // 0 for the searcher's default
+    bool            json = false;
+};
+
+// one line of the input file
+struct BatchPosition
+{
+    int             line;
+    std::string     state;
+};
+
+struct BatchResult
+{
+    int             line = 0;
+    std::string     state;
+    bool            valid = false;          // false when the state string didn't parse
+    bool            found = false;          // false when there was nothing to play
+    std::string     bestMove;
+    int             score = 0;
+    int             depth = 0;
+    uint64_t        nodes = 0;
+    double          milliseconds = 0;
+};
+
+//
+// writes results in input order, workers hand them over as they finish and anything that overtook a slower
+// position waits here until it's done
+//
+class ResultWriter
+{
+public:
+    ResultWriter(std::ostream &out, bool json) : _out(out), _json(json)
+    {
+        if (!_json) {
+            _out << "line,state,score,bestmove,depth,nodes,time_ms\n";
+        }
+    }
+
+    void add(int index, BatchResult &&result)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _waiting.emplace(index, std::move(result));
+        bool wrote = false;
+        for (auto it = _waiting.begin(); it != _waiting.end() && it->first == _next; it = _waiting.erase(it)) {
+            _write(it->second);
+            _next++;
+            wrote = true;
+        }
+        // flushed whenever something went out, so whatever reads the output sees results as they come
+        if (wrote) {
+            _out.flush();
+        }
+    }
+
+    int         analysed() const { return _analysed; }
+    int         skipped() const { return _skipped; }
+    uint64_t    nodes() const { return _nodes; }
+
+private:
+    void _write(const BatchResult &result)
+    {
+        if (!result.valid) {
+            std::cerr << "line " << result.line << ": bad state " << result.state << std::endl;
+            _skipped++;
+            return;
+        }
+        _analysed++;
+        _nodes += result.nodes;
+        char time[32];
+        snprintf(time, sizeof(time), "%.3f", result.milliseconds);
+        std::string move = result.found ? result.bestMove : "(none)";
+        if (_json) {
+            _out << "{\"line\":" << result.line << ",\"state\":\"" << _escaped(result.state, '\\') << "\",\"score\":" << result.score
+                 << ",\"bestmove\":\"" << _escaped(move, '\\') << "\",\"depth\":" << result.depth << ",\"nodes\":" << result.nodes
+                 << ",\"time_ms\":" << time << "}\n";
+        } else {
+            _out << result.line << ",\"" << _escaped(result.state, '"') << "\"," << result.score << ",\"" << _escaped(move, '"') << "\","
+                 << result.depth << "," << result.nodes << "," << time << "\n";
+        }
+    }
+
+    // quotes inside a quoted field, doubled for csv and backslashed for json
+    static std::string _escaped(const std::string &text, char escape)
+    {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || (escape == '\\' && c == '\\')) {
+                escaped += escape;
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    std::ostream                &_out;
+    bool                        _json;
+    std::mutex                  _mutex;
+    std::map<int, BatchResult>  _waiting;
+    int                         _next = 0;
+    int                         _analysed = 0;
+    int                         _skipped = 0;
+    uint64_t                    _nodes = 0;
+};
+
+//
+// searches positions as tasks on the shared scheduler, each task takes the next position as it finishes one
+//
+template <class Position>
+class BatchAnalysis
+{
+public:
+    BatchAnalysis(const AnalyseOptions &options, const std::vector<BatchPosition> &positions, ResultWriter &writer)
+        : _options(options), _positions(positions), _writer(writer), _next(0) {}
+
+    void run()
+    {
+        int threads = _options.threads > 0 ? _options.threads : Scheduler::shared().threads();
+        threads = std::max(1, std::min(threads, (int)_positions.size()));
+        std::vector<TaskHandle> tasks;
+        for (int i = 0; i < threads; i++) {
+            tasks.push_back(Scheduler::shared().submit([this](const std::atomic<bool> &stop) {
+                _worker();
+                return true;
+            }, Scheduler::NORMAL, "analyse"));
+        }
+        for (TaskHandle &task : tasks) {
+            task.wait();
+        }
+    }
+
+private:
+    typedef typename SearcherFor<Position>::Type GameSearcher;
+
+    void _worker()
+    {
+        // searchers carry their principal variation tables inline, keep them off the worker's stack
+        std::unique_ptr<GameSearcher> searcher = std::make_unique<GameSearcher>();
+        if (_options.hashMegabytes > 0) {
+            searcher->setTableSize(_options.hashMegabytes);
+        }
+        SearchLimits limits;
+        limits.depth = _options.depth;
+        limits.movetime = _options.movetime;
+        for (int i = _next++; i < (int)_positions.size(); i = _next++) {
+            const BatchPosition &input = _positions[i];
+            BatchResult result;
+            result.line = input.line;
+            result.state = input.state;
+            Position position;
+            if (_parse(input.state, position)) {
+                result.valid = true;
+                auto start = std::chrono::steady_clock::now();
+                SearchResult<Position> search = searcher->search(position, limits);
+                result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                result.found = search.found;
+                result.bestMove = search.found ? position.moveToString(search.bestMove) : std::string();
+                result.score = search.score;
+                result.depth = search.depth;
+                result.nodes = search.nodes;
+            }
+            _writer.add(i, std::move(result));
+        }
+    }
+
+    static bool _parse(const std::string &text, Position &position)
+    {
+        std::string state = text;
+        int side = -1;
+        size_t at = text.rfind(" side ");
+        if (at != std::string::npos && at + 7 == text.size() && (text[at + 6] == '1' || text[at + 6] == '2')) {
+            state = text.substr(0, at);
+            side = text[at + 6] - '1';
+        }
+        if (!position.setStateString(state)) {
+            return false;
+        }
+        if (side >= 0) {
+            if constexpr (requires(Position p) { p.setSideToMove(0); }) {
+                position.setSideToMove(side);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const AnalyseOptions                &_options;
+    const std::vector<BatchPosition>    &_positions;
+    ResultWriter                        &_writer;
+    std::atomic<int>                    _next;
+};
+
+static bool readPositions(std::istream &input, std::vector<BatchPosition> &positions)
+{
+    std::string text;
+    int line = 0;
+    while (std::getline(input, text)) {
+        line++;
+        // files written on windows keep their \r
+        if (!text.empty() && text.back() == '\r') {
+            text.pop_back();
+        }
+        if (text.empty() || text[0] == '#') {
+            continue;
+        }
+        positions.push_back({ line, text });
+    }
+    return !input.bad();
+}
+
+template <class Position>
+static void runAnalysis(const AnalyseOptions &options, const std::vector<BatchPosition> &positions, ResultWriter &writer)
+{
+    BatchAnalysis<Position> analysis(options, positions, writer);
+    analysis.run();
+}
+
+static int usage()
+{
+    std::cout << "usage: analyse <connect4|othello|checkers|tictactoe|chess> <file|-> [--depth plies] [--movetime ms]\n"
+                 "               [--threads n] [--hash mb] [--json] [--output file]" << std::endl;
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        return usage();
+    }
+    AnalyseOptions options;
+    options.game = argv[1];
+    options.inputPath = argv[2];
+    bool haveDepth = false;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--depth" && hasValue) {
+            options.depth = atoi(argv[++i]);
+            haveDepth = true;
+        } else if (arg == "--movetime" && hasValue) {
+            options.movetime = atoll(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = atoi(argv[++i]);
+        } else if (arg == "--hash" && hasValue) {
+            options.hashMegabytes = (size_t)atoll(argv[++i]);
+        } else if (arg == "--json") {
+            options.json = true;
+        } else if (arg == "--output" && hasValue) {
+            options.outputPath = argv[++i];
+        } else {
+            return usage();
+        }
+    }
+    // a time limit on its own means search as deep as the time allows
+    if (options.movetime > 0 && !haveDepth) {
+        options.depth = SEARCH_MAX_PLY;
+    }
+    if (options.depth <= 0) {
+        return usage();
+    }
+
+    std::vector<BatchPosition> positions;
+    if (options.inputPath == "-") {
+        readPositions(std::cin, positions);
+    } else {
+        std::ifstream input(options.inputPath);
+        if (!input || !readPositions(input, positions)) {
+            std::cerr << "can't read " << options.inputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ofstream file;
+    if (!options.outputPath.empty()) {
+        file.open(options.outputPath);
+        if (!file) {
+            std::cerr << "can't write " << options.outputPath << std::endl;
+            return 1;
+        }
+    }
+    ResultWriter writer(options.outputPath.empty() ? std::cout : file, options.json);
+
+    auto start = std::chrono::steady_clock::now();
+    if (options.game == "connect4") runAnalysis<Connect4Position>(options, positions, writer);
+    else if (options.game == "othello") runAnalysis<OthelloPosition>(options, positions, writer);
+    else if (options.game == "checkers") runAnalysis<CheckersPosition>(options, positions, writer);
+    else if (options.game == "tictactoe") runAnalysis<TicTacToePosition>(options, positions, writer);
+    else if (options.game == "chess") runAnalysis<ChessPosition>(options, positions, writer);
+    else return usage();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    char summary[160];
+    snprintf(summary, sizeof(summary), "%d positions in %.2fs, %.1f positions/s, %.0f nodes/s", writer.analysed(), seconds,
+             seconds > 0 ? writer.analysed() / seconds : 0.0, seconds > 0 ? writer.nodes() / seconds : 0.0);
+    std::cerr << summary;
+    if (writer.skipped() > 0) {
+        std::cerr << ", " << writer.skipped() << " bad lines skipped";
+    }
+    std::cerr << std::endl;
+    return writer.skipped() > 0 ? 1 : 0;
+}
@@ -0,0 +1,360 @@
+//
+// micro benchmarks for the rules and search in gamecore, laid out like google benchmark's output
+// each game has a fixed suite of positions reached by playing moves from the start, so numbers
+// stay comparable from run to run
+//
+//   bench [--quick] [--json <file>] [--filter <text>]
+//
+// --quick runs every benchmark for a short time and searches shallower, it's what ctest uses
+// --json writes the results in google benchmark's json layout for tracking over time
+//
+#include "core/Connect4Position.h"
+#include "core/OthelloPosition.h"
+#include "core/CheckersPosition.h"
+#include "core/TicTacToePosition.h"
+#include "core/ChessSearch.h"
+#include "core/Search.h"
+#include "core/SlicedSearch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct BenchResult
+{
+    std::string name;
+    uint64_t    iterations;
+    double      nanosecondsPerOp;
+    double      nodesPerSecond;     // only searches fill this in
+};
+
+struct BenchOptions
+{
+    bool        quick = false;
+    std::string jsonPath;
+    std::string filter;
+};
+
+// results have to go somewhere or the compiler throws the work away
+static volatile uint64_t benchSink;
+
+//
+// run op in growing batches until it has taken at least minSeconds, op returns how many operations it did
+//
+static BenchResult measure(const std::string &name, double minSeconds, const std::function<uint64_t()> &op)
+{
+    typedef std::chrono::steady_clock Clock;
+    uint64_t batch = 1;
+    while (true) {
+        uint64_t operations = 0;
+        Clock::time_point start = Clock::now();
+        for (uint64_t i = 0; i < batch; i++) {
+            operations += op();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= minSeconds || batch >= (1ULL << 40)) {
+            return { name, operations, seconds * 1e9 / (double)(operations ? operations : 1), 0.0 };
+        }
+        // aim straight for the target once there's a useful reading
+        batch = seconds > minSeconds / 100 ? (uint64_t)(batch * minSeconds * 1.2 / seconds) + 1 : batch * 10;
+    }
+}
+
+//
+// the benchmarks every game gets: move generation, play/undo, eval, win check and a fixed depth search
+// plus random playouts for games that can run them on their own bitboards
+//
+template <class Position>
+class GameBench
+{
+public:
+    typedef typename Position::Move Move;
+
+    GameBench(const std::string &game, const std::vector<std::string> &lines, int searchDepth)
+        : _game(game), _searchDepth(searchDepth), _badLines(0), _slicedMismatches(0)
+    {
+        for (const std::string &line : lines) {
+            Position position;
+            if (_playLine(position, line)) {
+                _positions.push_back(position);
+            } else {
+                std::cout << _game << ": bad suite line \"" << line << "\"" << std::endl;
+                _badLines++;
+            }
+        }
+    }
+
+    // a suite line that doesn't play out means the rules changed under the benchmark
+    bool valid() const { return _badLines == 0 && _slicedMismatches == 0; }
+
+    void run(const BenchOptions &options, double minSeconds, std::vector<BenchResult> &results)
+    {
+        if (_positions.empty()) {
+            return;
+        }
+        _run(options, results, "movegen", minSeconds, [this]() {
+            uint64_t generated = 0;
+            for (const Position &position : _positions) {
+                typename Position::Moves moves;
+                position.moves(moves);
+                generated += moves.size();
+            }
+            benchSink = generated;
+            return (uint64_t)_positions.size();
+        });
+        _run(options, results, "play_undo", minSeconds, [this]() {
+            uint64_t operations = 0;
+            for (Position &position : _positions) {
+                typename Position::Moves moves;
+                position.moves(moves);
+                for (const Move &move : moves) {
+                    position.play(move);
+                    position.undo(move);
+                }
+                operations += moves.size();
+            }
+            return operations;
+        });
+        _run(options, results, "eval", minSeconds, [this]() {
+            int total = 0;
+            for (const Position &position : _positions) {
+                total += position.eval();
+            }
+            benchSink = (uint64_t)total;
+            return (uint64_t)_positions.size();
+        });
+        _run(options, results, "win_check", minSeconds, [this]() {
+            uint64_t over = 0;
+            for (const Position &position : _positions) {
+                over += _winCheck(position);
+            }
+            benchSink = over;
+            return (uint64_t)_positions.size();
+        });
+        // the random games monte carlo search runs, one per suite position
+        if constexpr (requires(const Position &p, uint64_t &seed) { p.randomPlayout(seed); }) {
+            _run(options, results, "playout", minSeconds, [this]() {
+                uint64_t seed = 0x9e3779b97f4a7c15ULL;
+                int wins = 0;
+                for (const Position &position : _positions) {
+                    wins += position.randomPlayout(seed);
+                }
+                benchSink = (uint64_t)wins;
+                return (uint64_t)_positions.size();
+            });
+        }
+
+        int depth = options.quick ? (_searchDepth + 1) / 2 : _searchDepth;
+        SearchLimits limits;
+        limits.depth = depth;
+        std::string name = _game + "/search_depth_" + std::to_string(depth);
+        if (options.filter.empty() || name.find(options.filter) != std::string::npos) {
+            // every suite position searched once, nodes over time is the number that matters
+            auto searcher = std::make_unique<typename SearcherFor<Position>::Type>();
+            uint64_t nodes = 0;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (Position position : _positions) {
+                nodes += searcher->search(position, limits).nodes;
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            _addSearch(results, name, nodes, seconds);
+        }
+
+        // the same searches a slice at a time, they have to find the same moves with the same node counts as in one go
+        name = _game + "/sliced_search_depth_" + std::to_string(depth);
+        if (options.filter.empty() || name.find(options.filter) != std::string::npos) {
+            auto searcher = std::make_unique<typename SearcherFor<Position>::Type>();
+            auto sliced = std::make_unique<SlicedSearcher<Position>>();
+            uint64_t nodes = 0;
+            double seconds = 0;
+            for (Position position : _positions) {
+                SearchResult<Position> expected = searcher->search(position, limits);
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                sliced->start(position, limits);
+                while (!sliced->resume(SLICE_MICROSECONDS)) {
+                }
+                seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                const SearchResult<Position> &result = sliced->result();
+                if (result.nodes != expected.nodes || result.score != expected.score || !(result.bestMove == expected.bestMove)) {
+                    std::cout << _game << ": sliced search found " << position.moveToString(result.bestMove) << " " << result.score
+                              << " in " << result.nodes << " nodes, in one go it's " << position.moveToString(expected.bestMove) << " "
+                              << expected.score << " in " << expected.nodes << std::endl;
+                    _slicedMismatches++;
+                }
+                nodes += result.nodes;
+            }
+            _addSearch(results, name, nodes, seconds);
+        }
+    }
+
+private:
+    // short enough that every sliced search is suspended and resumed many times
+    static const int64_t SLICE_MICROSECONDS = 50;
+
+    void _addSearch(std::vector<BenchResult> &results, const std::string &name, uint64_t nodes, double seconds)
+    {
+        BenchResult result = { name, nodes, nodes ? seconds * 1e9 / (double)nodes : 0.0, seconds > 0 ? nodes / seconds : 0.0 };
+        results.push_back(result);
+        _print(result);
+    }
+
+    bool _playLine(Position &position, const std::string &line) const
+    {
+        size_t start = 0;
+        while (start < line.size()) {
+            size_t end = line.find(' ', start);
+            if (end == std::string::npos) {
+                end = line.size();
+            }
+            if (end > start) {
+                Move move;
+                if (!position.parseMove(line.substr(start, end - start), move)) {
+                    return false;
+                }
+                position.play(move);
+            }
+            start = end + 1;
+        }
+        return true;
+    }
+
+    // the work the game window does after every move to see if somebody has won
+    static uint64_t _winCheck(const Position &position)
+    {
+        if constexpr (requires { Position::hasFour(0); }) {
+            return Position::hasFour(position.pieces(0)) + Position::hasFour(position.pieces(1));
+        } else {
+            return position.gameOver() + (position.winner() >= 0);
+        }
+    }
+
+    void _run(const BenchOptions &options, std::vector<BenchResult> &results, const char *kernel, double minSeconds, const std::function<uint64_t()> &op)
+    {
+        std::string name = _game + "/" + kernel;
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+            return;
+        }
+        results.push_back(measure(name, minSeconds, op));
+        _print(results.back());
+    }
+
+    static void _print(const BenchResult &result)
+    {
+        char line[160];
+        if (result.nodesPerSecond > 0) {
+            snprintf(line, sizeof(line), "%-32s %12.1f ns/node %14llu nodes %12.0f nodes/s",
+                     result.name.c_str(), result.nanosecondsPerOp, (unsigned long long)result.iterations, result.nodesPerSecond);
+        } else {
+            snprintf(line, sizeof(line), "%-32s %12.1f ns/op   %14llu iterations",
+                     result.name.c_str(), result.nanosecondsPerOp, (unsigned long long)result.iterations);
+        }
+        std::cout << line << std::endl;
+    }
+
+    std::string             _game;
+    int                     _searchDepth;
+    int                     _badLines;
+    int                     _slicedMismatches;
+    std::vector<Position>   _positions;
+};
+
+static bool writeJson(const std::string &path, const std::vector<BenchResult> &results)
+{
+    std::ofstream out(path);
+    if (!out) {
+        std::cout << "can't write " << path << std::endl;
+        return false;
+    }
+    char date[32];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    out << "{\n  \"context\": {\n";
+    out << "    \"date\": \"" << date << "\",\n";
+#if defined(NDEBUG)
+    out << "    \"library_build_type\": \"release\"\n";
+#else
+    out << "    \"library_build_type\": \"debug\"\n";
+#endif
+    out << "  },\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &result = results[i];
+        out << "    {\n";
+        out << "      \"name\": \"" << result.name << "\",\n";
+        out << "      \"run_type\": \"iteration\",\n";
+        out << "      \"iterations\": " << result.iterations << ",\n";
+        out << "      \"real_time\": " << result.nanosecondsPerOp << ",\n";
+        out << "      \"cpu_time\": " << result.nanosecondsPerOp << ",\n";
+        if (result.nodesPerSecond > 0) {
+            out << "      \"nodes_per_second\": " << result.nodesPerSecond << ",\n";
+        }
+        out << "      \"time_unit\": \"ns\"\n";
+        out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            options.quick = true;
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            options.jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else {
+            std::cout << "usage: bench [--quick] [--json <file>] [--filter <text>]" << std::endl;
+            return 1;
+        }
+    }
+    double minSeconds = options.quick ? 0.02 : 0.5;
+
+    // start, middle and late positions for each game, moves in each position's own notation
+    GameBench<Connect4Position> connect4("connect4", {
+        "",
+        "4 7 6 3 5 7 5 2 1 3",
+        "4 7 6 3 5 7 5 2 1 3 7 2 7 2 3 4 2 3",
+    }, 10);
+    GameBench<OthelloPosition> othello("othello", {
+        "",
+        "e6 f4 c3 c4 e3 d6 b4 b3 b2 c2 c6 e2 f2 a4 a2 b7 d3 f6 f5 g5",
+        "e6 f4 c3 c4 e3 d6 b4 b3 b2 c2 c6 e2 f2 a4 a2 b7 d3 f6 f5 g5 e1 a1 d2 g1 g6 c5 g2 g4 a5 g3 h4 h6 h7 a3 b6 f7 f8 c1 f3 a6 c7 h3 a8 e7",
+    }, 7);
+    GameBench<CheckersPosition> checkers("checkers", {
+        "",
+        "b6-a5 c3-d4 a7-b6 g3-h4 b6-c5 d4xb6 d6-e5 b2-c3 h6-g5 a1-b2 e5-d4 c3xe5 f6xd4 e3xc5 c7-d6 h4xf6",
+        "b6-a5 c3-d4 a7-b6 g3-h4 b6-c5 d4xb6 d6-e5 b2-c3 h6-g5 a1-b2 e5-d4 c3xe5 f6xd4 e3xc5 c7-d6 h4xf6 d6xb4 a3xc5 e7xg5 f2-g3 "
+        "g5-h4 g3-f4 d8-e7 b6-c7 b8xd6xb4 h2-g3 h4xf2 g1xe3 e7-f6 f4-g5 f6xh4 b2-c3 g7-f6 e3-d4 f8-g7 c1-b2 h4-g3 d4-c5 g3-f2 e1xg3",
+    }, 9);
+    GameBench<TicTacToePosition> tictactoe("tictactoe", {
+        "",
+        "9 7 6 4",
+    }, 9);
+    GameBench<ChessPosition> chess("chess", {
+        "",
+        "e2e4 e7e5 g1f3 b8c6 f1b5 a7a6 b5a4 g8f6 e1g1 f8e7 f1e1 b7b5 a4b3 d7d6 c2c3 e8g8",
+        "e2e4 e7e5 g1f3 b8c6 f1b5 a7a6 b5a4 g8f6 e1g1 f8e7 f1e1 b7b5 a4b3 d7d6 c2c3 e8g8 h2h3 c6a5 b3c2 c7c5 "
+        "d2d4 d8c7 b1d2 c5d4 c3d4 a5c6 d4d5 c6b4 c2b1 a6a5 a2a3 b4a6 b2b4 a5b4 a3b4 c7b7 a1a6 b7a6",
+    }, 5);
+
+    std::vector<BenchResult> results;
+    connect4.run(options, minSeconds, results);
+    othello.run(options, minSeconds, results);
+    checkers.run(options, minSeconds, results);
+    tictactoe.run(options, minSeconds, results);
+    chess.run(options, minSeconds, results);
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, results)) {
+        return 1;
+    }
+    bool valid = connect4.valid() && othello.valid() && checkers.valid() && tictactoe.valid() && chess.valid();
+    return valid && !results.empty() ? 0 : 1;
+}
@@ -0,0 +1,522 @@
+//
+// text protocol front end for the game engines, modelled on UCI so existing tournament managers and GUIs can drive them
+// built only with the UCI_INTERFACE option, it links gamecore and nothing from ImGui
+//
+//   uci                                       identify, list options, answer uciok
+//   isready                                   answer readyok
+//   setoption name Game value <game>          connect4, othello, checkers, tictactoe or chess
+//   setoption name MCTS value off|tree|root   play go with monte carlo search instead, tree or root parallel
+//   setoption name Threads value <n>          monte carlo threads, 0 for one per core
+//   setoption name Hash value <mb>            transposition table megabytes, kept across searches until ucinewgame
+//   setoption name LargePages value <bool>    back the table with huge pages where the system allows
+//   ucinewgame                                back to the start position
+//   position startpos [moves m1 m2 ...]
+//   position state <state> [side 1|2] [moves m1 m2 ...]
+//   position fen <fen> [moves m1 m2 ...]      the same as state, chess states are FEN
+//   go [depth n] [movetime ms] [wtime ms btime ms winc ms binc ms] [infinite]
+//                                             infinite ignores every limit and holds bestmove back until stop
+//   stop                                      finish the search now and answer bestmove
+//   d                                         print the current state string and side to move
+//   trace start | trace save <file>           record searches and write them as chrome trace json
+//   perft <depth> [threads n] [expect nodes]  count every line to depth, with nodes per second
+//   divide <depth> [threads n]                perft broken down by root move
+//   quit
+//
+// commands given after the game on the command line are run in order instead of reading stdin,
+// so "engine chess 'position startpos' 'perft 5 expect 4865609'" exits with 1 if the count is wrong
+//
+// moves are written the way each position's moveToString writes them,
+// columns 1-7 for connect 4, a1-h8 or pass for othello, c3-d4 or c3xe5 for checkers, e2e4 or e7e8q for chess
+//
+#include "core/Connect4Position.h"
+#include "core/OthelloPosition.h"
+#include "core/CheckersPosition.h"
+#include "core/TicTacToePosition.h"
+#include "core/ChessSearch.h"
+#include "core/Search.h"
+#include "core/MCTS.h"
+#include "core/Perft.h"
+#include "core/Scheduler.h"
+#include "core/Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// what UCI engines usually start with
+static const size_t DEFAULT_HASH_MEGABYTES = 16;
+
+static std::mutex outputMutex;
+
+// the search thread and the input loop both write, keep whole lines together
+static void say(const std::string &line)
+{
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << std::endl;
+}
+
+//
+// one game's position and search behind a common interface so the protocol code doesn't care which it is
+//
+class EngineGame
+{
+public:
+    virtual ~EngineGame() {}
+
+    virtual void        newGame() = 0;
+    // empty state means the start position, side is a player number or -1 to keep the position's guess
+    virtual bool        setPosition(const std::string &state, int side, const std::vector<std::string> &moves) = 0;
+    virtual std::string stateString() const = 0;
+    virtual int         sideToMove() const = 0;
+    // search until a limit is hit, printing info lines and then bestmove
+    // infinite searches have no limits but stop, and bestmove waits for stop even if the search ends first
+    virtual void        go(const SearchLimits &limits, bool infinite) = 0;
+    // transposition table size for go, the table is made again on the next search
+    virtual void        setHash(size_t megabytes, bool hugePages) = 0;
+    // the same with monte carlo search, depth is ignored and the tree is kept for the next go
+    virtual void        goMcts(const SearchLimits &limits, bool infinite, int threads, bool rootParallel) = 0;
+    // leaf count to depth, with each root move's count printed first when dividing
+    virtual uint64_t    perft(int depth, int threads, bool divide) = 0;
+};
+
+template <class Position>
+class EngineGameFor : public EngineGame
+{
+public:
+    void newGame() override
+    {
+        _position = Position();
+        if (_searcher) {
+            _searcher->clearTable();
+        }
+        if (_mcts) {
+            _mcts->reset();
+        }
+    }
+
+    void setHash(size_t megabytes, bool hugePages) override
+    {
+        _hashMegabytes = megabytes;
+        _hugePages = hugePages;
+        _searcher.reset();
+    }
+
+    bool setPosition(const std::string &state, int side, const std::vector<std::string> &moves) override
+    {
+        Position position;
+        if (!state.empty() && !position.setStateString(state)) {
+            say("info string bad state " + state);
+            return false;
+        }
+        if (side >= 0) {
+            // only games whose board can't tell whose turn it is let you say
+            if constexpr (requires(Position p) { p.setSideToMove(0); }) {
+                position.setSideToMove(side);
+            }
+        }
+        for (const std::string &text : moves) {
+            typename Position::Move move;
+            if (!position.parseMove(text, move)) {
+                say("info string illegal move " + text);
+                return false;
+            }
+            position.play(move);
+        }
+        _position = position;
+        return true;
+    }
+
+    std::string stateString() const override
+    {
+        return _position.stateString();
+    }
+
+    int sideToMove() const override
+    {
+        return _position.sideToMove();
+    }
+
+    void go(const SearchLimits &limits, bool infinite) override
+    {
+        Position position = _position;
+        // kept so the table carries over from one go to the next
+        if (!_searcher) {
+            _searcher = std::make_unique<GameSearcher>(0);
+            _searcher->setTableSize(_hashMegabytes, _hugePages);
+        }
+        SearchResult<Position> result = _searcher->search(position, limits, [&](const SearchResult<Position> &iteration) {
+            say(_infoLine(position, iteration) + " hashfull " + std::to_string(_searcher->stats().tableFill));
+        });
+        if (infinite) {
+            _waitForStop(limits);
+        }
+        if (!result.found) {
+            say("bestmove (none)");
+            return;
+        }
+        say("bestmove " + position.moveToString(result.bestMove));
+    }
+
+    void goMcts(const SearchLimits &limits, bool infinite, int threads, bool rootParallel) override
+    {
+        if (!_mcts) {
+            _mcts = std::make_unique<Mcts<Position>>();
+        }
+        if (_mcts->threads() != threads) {
+            _mcts->setThreads(threads);
+        }
+        _mcts->setParallelism(rootParallel ? Mcts<Position>::ROOT_PARALLEL : Mcts<Position>::TREE_PARALLEL);
+        MctsLimits mctsLimits;
+        mctsLimits.movetime = limits.movetime;
+        mctsLimits.stop = limits.stop;
+        MctsResult<Position> result = _mcts->search(_position, mctsLimits);
+        if (infinite) {
+            _waitForStop(limits);
+        }
+        if (!result.found) {
+            say("bestmove (none)");
+            return;
+        }
+        const SearchStats &stats = _mcts->stats();
+        std::ostringstream line;
+        line << "info depth " << stats.depth << " nodes " << result.playouts << " nps " << (int64_t)result.playoutsPerSecond()
+             << " time " << result.milliseconds << " pv " << stats.pv;
+        say(line.str());
+        say("info string playouts " + std::to_string(result.playouts) + " reused " + std::to_string(result.reusedPlayouts) +
+            " tree " + std::to_string(result.treeNodes) + " winrate " + std::to_string(stats.score) + " threads " + std::to_string(threads));
+        say("bestmove " + _position.moveToString(result.bestMove));
+    }
+
+    uint64_t perft(int depth, int threads, bool divide) override
+    {
+        PerftDivide<Position> result = perftDivide(_position, depth, threads);
+        if (divide) {
+            for (size_t i = 0; i < result.moves.size(); i++) {
+                say(_position.moveToString(result.moves[i]) + " " + std::to_string(result.nodes[i]));
+            }
+        }
+        return result.total;
+    }
+
+private:
+    // a search that ran out of moves to look at early still owes its bestmove to the stop
+    static void _waitForStop(const SearchLimits &limits)
+    {
+        if (limits.stop) {
+            limits.stop->wait(false);
+        }
+    }
+
+    std::string _infoLine(Position &position, const SearchResult<Position> &result) const
+    {
+        std::ostringstream line;
+        line << "info depth " << result.depth;
+        if (isWinScore(result.score)) {
+            // plies to the end of the game, counted in our own moves like chess mates
+            int plies = SEARCH_WIN_SCORE - (result.score > 0 ? result.score : -result.score);
+            int moves = (plies + 1) / 2;
+            line << " score mate " << (result.score > 0 ? moves : -moves);
+        } else {
+            line << " score cp " << result.score;
+        }
+        int64_t nps = result.milliseconds > 0 ? (int64_t)(result.nodes * 1000 / result.milliseconds) : (int64_t)result.nodes;
+        line << " nodes " << result.nodes << " nps " << nps << " time " << result.milliseconds;
+        if (!result.pv.empty()) {
+            // each move is written in the position it's played from
+            line << " pv";
+            for (const auto &move : result.pv) {
+                line << " " << position.moveToString(move);
+                position.play(move);
+            }
+            for (size_t i = result.pv.size(); i > 0; i--) {
+                position.undo(result.pv[i - 1]);
+            }
+        }
+        return line.str();
+    }
+
+    typedef typename SearcherFor<Position>::Type GameSearcher;
+
+    Position _position;
+    // the searcher keeps its principal variation tables inline, too big for some thread stacks
+    std::unique_ptr<GameSearcher> _searcher;
+    size_t  _hashMegabytes = DEFAULT_HASH_MEGABYTES;
+    bool    _hugePages = false;
+    // made on the first monte carlo go and kept so its tree carries over to the next
+    std::unique_ptr<Mcts<Position>> _mcts;
+};
+
+static std::unique_ptr<EngineGame> createGame(const std::string &name)
+{
+    if (name == "connect4") return std::make_unique<EngineGameFor<Connect4Position>>();
+    if (name == "othello") return std::make_unique<EngineGameFor<OthelloPosition>>();
+    if (name == "checkers") return std::make_unique<EngineGameFor<CheckersPosition>>();
+    if (name == "tictactoe") return std::make_unique<EngineGameFor<TicTacToePosition>>();
+    if (name == "chess") return std::make_unique<EngineGameFor<ChessPosition>>();
+    return nullptr;
+}
+
+//
+// the protocol loop, searches run as scheduler tasks so stop can get through
+//
+class Engine
+{
+public:
+    Engine(const std::string &gameName) : _gameName(gameName), _game(createGame(gameName)), _stop(false) {}
+    ~Engine() { _stopSearch(); }
+
+    bool valid() const { return _game != nullptr; }
+    // true once a perft count didn't match what was expected
+    bool failed() const { return _failed; }
+
+    void run(std::istream &input)
+    {
+        std::string line;
+        while (std::getline(input, line)) {
+            std::istringstream tokens(line);
+            std::string command;
+            if (!(tokens >> command)) {
+                continue;
+            }
+            if (command == "quit") {
+                break;
+            } else if (command == "uci") {
+                say("id name My-Connect-4 " + _gameName);
+                say("option name Game type combo default " + _gameName + " var connect4 var othello var checkers var tictactoe var chess");
+                say("option name MCTS type combo default off var off var tree var root");
+                say("option name Threads type spin default 1 min 0 max 256");
+                say("option name Hash type spin default " + std::to_string(DEFAULT_HASH_MEGABYTES) + " min 0 max 65536");
+                say("option name LargePages type check default false");
+                say("uciok");
+            } else if (command == "isready") {
+                say("readyok");
+            } else if (command == "setoption") {
+                _setOption(tokens);
+            } else if (command == "ucinewgame") {
+                _stopSearch();
+                _game->newGame();
+            } else if (command == "position") {
+                _stopSearch();
+                _setPosition(tokens);
+            } else if (command == "go") {
+                _stopSearch();
+                _go(tokens);
+            } else if (command == "stop") {
+                _stopSearch();
+            } else if (command == "trace") {
+                _trace(tokens);
+            } else if (command == "perft" || command == "divide") {
+                _stopSearch();
+                _perft(tokens, command == "divide");
+            } else if (command == "d") {
+                say(_game->stateString() + " side " + std::to_string(_game->sideToMove() + 1));
+            } else {
+                say("info string unknown command " + command);
+            }
+        }
+        _stopSearch();
+    }
+
+private:
+    void _stopSearch()
+    {
+        _stop = true;
+        _stop.notify_all();
+        _search.wait();
+        _search = TaskHandle();
+        _stop = false;
+    }
+
+    void _setOption(std::istringstream &tokens)
+    {
+        std::string token, name, value;
+        tokens >> token >> name >> token >> value;
+        if (name == "MCTS") {
+            if (value != "off" && value != "tree" && value != "root") {
+                say("info string MCTS is off, tree or root");
+                return;
+            }
+            _stopSearch();
+            _mcts = value;
+            return;
+        }
+        if (name == "Threads") {
+            _stopSearch();
+            // 0 means one per core
+            _threads = atoi(value.c_str());
+            if (_threads <= 0) _threads = Scheduler::shared().threads();
+            return;
+        }
+        if (name == "Hash" || name == "LargePages") {
+            _stopSearch();
+            if (name == "Hash") {
+                _hash = (size_t)std::max(0, atoi(value.c_str()));
+            } else {
+                _largePages = value == "true";
+            }
+            _game->setHash(_hash, _largePages);
+            return;
+        }
+        if (name != "Game") {
+            say("info string unknown option " + name);
+            return;
+        }
+        auto game = createGame(value);
+        if (!game) {
+            say("info string unknown game " + value);
+            return;
+        }
+        _stopSearch();
+        _gameName = value;
+        _game = std::move(game);
+        _game->setHash(_hash, _largePages);
+    }
+
+    void _setPosition(std::istringstream &tokens)
+    {
+        std::string token, state;
+        int side = -1;
+        std::vector<std::string> moves;
+        tokens >> token;
+        if (token == "state" || token == "fen") {
+            // state strings may hold spaces, everything up to side or moves belongs to it
+            while (tokens >> token && token != "side" && token != "moves") {
+                state += state.empty() ? token : " " + token;
+            }
+            if (token == "side" && tokens >> side) {
+                side -= 1;
+                tokens >> token;
+            }
+        } else if (token == "startpos") {
+            tokens >> token;
+        } else {
+            say("info string position needs startpos, state or fen");
+            return;
+        }
+        if (token == "moves") {
+            while (tokens >> token) {
+                moves.push_back(token);
+            }
+        }
+        _game->setPosition(state, side, moves);
+    }
+
+    void _go(std::istringstream &tokens)
+    {
+        SearchLimits limits;
+        limits.stop = &_stop;
+        int64_t times[2] = { 0, 0 };
+        int64_t increments[2] = { 0, 0 };
+        bool infinite = false;
+        std::string token;
+        while (tokens >> token) {
+            if (token == "infinite") infinite = true;
+            else if (token == "depth") tokens >> limits.depth;
+            else if (token == "movetime") tokens >> limits.movetime;
+            else if (token == "wtime") tokens >> times[0];
+            else if (token == "btime") tokens >> times[1];
+            else if (token == "winc") tokens >> increments[0];
+            else if (token == "binc") tokens >> increments[1];
+        }
+        // with a clock and no fixed time, spend a slice of what's left
+        int side = _game->sideToMove();
+        if (infinite) {
+            limits.depth = SEARCH_MAX_PLY;
+            limits.movetime = 0;
+        } else if (limits.movetime == 0 && times[side] > 0) {
+            limits.movetime = times[side] / 30 + increments[side] / 2;
+        }
+        EngineGame *game = _game.get();
+        std::string mcts = _mcts;
+        int threads = _threads;
+        // the move the gui is waiting on, ahead of anything else the scheduler has queued
+        _search = Scheduler::shared().submit([game, limits, infinite, mcts, threads](const std::atomic<bool> &stop) {
+            if (mcts == "off") {
+                game->go(limits, infinite);
+            } else {
+                game->goMcts(limits, infinite, threads, mcts == "root");
+            }
+            return true;
+        }, Scheduler::URGENT, "go");
+    }
+
+    void _trace(std::istringstream &tokens)
+    {
+        std::string action, path;
+        tokens >> action >> path;
+        if (action == "start") {
+            Tracer::shared().setEnabled(true);
+        } else if (action == "save" && !path.empty()) {
+            Tracer::shared().setEnabled(false);
+            say(Tracer::shared().writeJson(path) ? "info string trace saved to " + path : "info string can't write " + path);
+        } else {
+            say("info string trace start or trace save <file>");
+        }
+    }
+
+    void _perft(std::istringstream &tokens, bool divide)
+    {
+        int depth = 0, threads = 1;
+        uint64_t expected = 0;
+        bool checking = false;
+        std::string token;
+        tokens >> depth;
+        while (tokens >> token) {
+            if (token == "threads") {
+                tokens >> threads;
+                // 0 means one per core
+                if (threads <= 0) threads = Scheduler::shared().threads();
+            } else if (token == "expect") {
+                checking = (bool)(tokens >> expected);
+            }
+        }
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        uint64_t nodes = _game->perft(depth, threads, divide);
+        int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        uint64_t nps = ms > 0 ? nodes * 1000 / (uint64_t)ms : nodes;
+        say("info string perft depth " + std::to_string(depth) + " nodes " + std::to_string(nodes) +
+            " time " + std::to_string(ms) + " nps " + std::to_string(nps) + " threads " + std::to_string(threads));
+        if (checking && nodes != expected) {
+            say("info string perft expected " + std::to_string(expected));
+            _failed = true;
+        }
+    }
+
+    std::string                 _gameName;
+    std::unique_ptr<EngineGame> _game;
+    std::atomic<bool>           _stop;
+    TaskHandle                  _search;
+    bool                        _failed = false;
+    std::string                 _mcts = "off";
+    int                         _threads = 1;
+    size_t                      _hash = DEFAULT_HASH_MEGABYTES;
+    bool                        _largePages = false;
+};
+
+int main(int argc, char **argv)
+{
+    Tracer::shared().setThreadName("main");
+    std::string gameName = argc > 1 ? argv[1] : "connect4";
+    Engine engine(gameName);
+    if (!engine.valid()) {
+        std::cerr << "unknown game " << gameName << ", try connect4, othello, checkers, tictactoe or chess" << std::endl;
+        return 1;
+    }
+    if (argc > 2) {
+        std::string commands;
+        for (int i = 2; i < argc; i++) {
+            commands += std::string(argv[i]) + "\n";
+        }
+        std::istringstream input(commands);
+        engine.run(input);
+    } else {
+        engine.run(std::cin);
+    }
+    return engine.failed() ? 1 : 0;
+}
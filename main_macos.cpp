@@ -17,6 +17,7 @@
 #endif
 #include <GLFW/glfw3.h> // Will drag system OpenGL headers
 #include "Application.h"
+#include "classes/Profiler.h"
 
 // [Win32] Our example includes a copy of glfw3.lib pre-compiled with VS2010 to maximize ease of testing and compatibility with old VS compilers.
 // To link with VS2010-era libraries, VS2015+ requires linking with legacy_stdio_definitions.lib, which we do using this pragma.
@@ -30,6 +31,9 @@
 #include "../libs/emscripten/emscripten_mainloop_stub.h"
 #endif
 
+// Longest we sleep while idle, ImGui still gets the odd frame for its own timers (tooltips, blinking cursor)
+static const double kIdleWaitSeconds = 0.25;
+
 static void glfw_error_callback(int error, const char* description)
 {
     fprintf(stderr, "GLFW Error %d: %s\n", error, description);
@@ -120,6 +124,7 @@ int main(int, char**)
     bool show_demo_window = true;
     bool show_another_window = false;
     ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
+    ClassGame::SetWakeUp([]() { glfwPostEmptyEvent(); });
     ClassGame::GameStartUp();
     
     // Main loop
@@ -137,9 +142,26 @@ int main(int, char**)
         // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite your copy of the mouse data.
         // - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or clear/overwrite your copy of the keyboard data.
         // Generally you may always pass all inputs to dear imgui, and hide them from your application based on those two flags.
+#ifdef __EMSCRIPTEN__
         glfwPollEvents();
+#else
+        // When nothing is changing (no input, no animation, no AI to move) sleep until an event arrives
+        // instead of redrawing every vsync. Waking before the timeout means input came in, so draw a few frames.
+        if (ClassGame::NeedsRedraw())
+        {
+            glfwPollEvents();
+        }
+        else
+        {
+            double waitStart = glfwGetTime();
+            glfwWaitEventsTimeout(kIdleWaitSeconds);
+            if (glfwGetTime() - waitStart < kIdleWaitSeconds)
+                ClassGame::RequestRedraw();
+        }
+#endif
 
         // Start the Dear ImGui frame
+        FrameProfiler::shared().beginFrame();
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
@@ -147,6 +169,7 @@ int main(int, char**)
         ClassGame::RenderGame();
 
         // Rendering
+        ProfileScope renderScope(ProfilePhase::Render);
         ImGui::Render();
         int display_w, display_h;
         glfwGetFramebufferSize(window, &display_w, &display_h);
@@ -165,6 +188,8 @@ int main(int, char**)
             ImGui::RenderPlatformWindowsDefault();
             glfwMakeContextCurrent(backup_current_context);
         }
+        renderScope.stop();
+        FrameProfiler::shared().endFrame();
 
         glfwSwapBuffers(window);
     }
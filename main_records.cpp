@@ -0,0 +1,133 @@
+//
+// reads a game record file, the app's games.mc4r or one written by tournament --record
+//
+//   records <file> [--replay] [--list]
+//     --replay   play every game through its title's rules, checks every move is legal and times it
+//     --list     print each game, title, result, start and moves, one per line
+//
+// without either it's a count of games and results per title, read straight off the mapped file
+//
+#include "core/Connect4Position.h"
+#include "core/OthelloPosition.h"
+#include "core/CheckersPosition.h"
+#include "core/TicTacToePosition.h"
+#include "core/ChessPosition.h"
+#include "core/GameRecord.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+struct TitleCounts
+{
+    uint64_t    games = 0;
+    uint64_t    results[4] = {};
+    uint64_t    moves = 0;
+    uint64_t    badGames = 0;     // start or a move the rules don't accept, only counted with --replay
+};
+
+// who won, players go by who moved first from the usual start
+static const char *kResultNames[4] = { "unfinished", "first", "second", "draw" };
+
+// replays game, printing it when list is set, false if the rules reject it
+template <class Position>
+static bool replay(const GameRecordView &game, bool list)
+{
+    Position position;
+    std::string moves;
+    bool legal = replayGameRecord(game, position, [&](const Position &before, const typename Position::Move &move) {
+        if (list) {
+            moves += ' ';
+            moves += before.moveToString(move);
+        }
+    });
+    if (list) {
+        std::cout << gameRecordTitleName(game.title) << ' ' << kResultNames[game.result & 3] << " [" << game.start << "]" << moves
+                  << (legal ? "" : " (illegal)") << '\n';
+    }
+    return legal;
+}
+
+static bool replay(const GameRecordView &game, bool list)
+{
+    switch (game.title) {
+    case RECORD_CONNECT4: return replay<Connect4Position>(game, list);
+    case RECORD_OTHELLO: return replay<OthelloPosition>(game, list);
+    case RECORD_CHECKERS: return replay<CheckersPosition>(game, list);
+    case RECORD_TICTACTOE: return replay<TicTacToePosition>(game, list);
+    case RECORD_CHESS: return replay<ChessPosition>(game, list);
+    default: return false;
+    }
+}
+
+static int usage()
+{
+    std::cout << "usage: records <file> [--replay] [--list]" << std::endl;
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        return usage();
+    }
+    std::string path = argv[1];
+    bool replayGames = false;
+    bool list = false;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--replay") {
+            replayGames = true;
+        } else if (arg == "--list") {
+            list = true;
+        } else {
+            return usage();
+        }
+    }
+
+    GameRecordFile file;
+    if (!file.open(path)) {
+        std::cerr << "can't read " << path << " as a game record file" << std::endl;
+        return 1;
+    }
+    TitleCounts counts[RECORD_TITLES];
+    uint64_t games = 0, unknown = 0, bad = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const GameRecordView &game : file) {
+        games++;
+        if (game.title >= RECORD_TITLES) {
+            unknown++;
+            continue;
+        }
+        TitleCounts &title = counts[game.title];
+        title.games++;
+        title.results[game.result & 3]++;
+        title.moves += game.moveCount;
+        if ((replayGames || list) && !replay(game, list)) {
+            title.badGames++;
+            bad++;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (int i = 0; i < RECORD_TITLES; i++) {
+        const TitleCounts &title = counts[i];
+        if (title.games == 0) {
+            continue;
+        }
+        printf("%-10s %10llu games  first %llu  second %llu  draw %llu  unfinished %llu  %.1f moves a game", gameRecordTitleName((GameRecordTitle)i),
+               (unsigned long long)title.games, (unsigned long long)title.results[RESULT_PLAYER1], (unsigned long long)title.results[RESULT_PLAYER2],
+               (unsigned long long)title.results[RESULT_DRAW], (unsigned long long)title.results[RESULT_UNFINISHED],
+               (double)title.moves / title.games);
+        if (title.badGames > 0) {
+            printf("  %llu illegal", (unsigned long long)title.badGames);
+        }
+        printf("\n");
+    }
+    if (unknown > 0) {
+        printf("%llu games of titles this build doesn't know\n", (unsigned long long)unknown);
+    }
+    printf("%llu games, %.1f MB in %.3fs, %.0f games/s%s\n", (unsigned long long)games, file.bytes() / (1024.0 * 1024.0), seconds,
+           seconds > 0 ? games / seconds : 0.0, replayGames ? " replayed" : "");
+    return bad > 0 ? 1 : 0;
+}
@@ -0,0 +1,455 @@
+//
+// self-play tournaments between two engine settings, to tell a stronger AI from a merely faster one
+// plays the same gamecore rules as the game window, so any title in the menu can be tested
+//
+//   tournament <game> [options]
+//     --a <config>          first engine, e.g. depth=6 or time=50,eval=noise:20
+//     --b <config>          second engine, defaults to the same as the first
+//     --games <n>           games to play, pairs of the same opening with colours swapped (default 200)
+//     --threads <n>         games played at once, no more than there are cores (default one per core)
+//     --openings <plies>    random plies played before the engines take over (default 4)
+//     --seed <n>            seed for the openings
+//     --sprt <elo0> <elo1>  stop as soon as A is shown to be elo1 stronger or not elo0 stronger
+//     --alpha <a> --beta <b>  sprt error rates (default 0.05)
+//     --trace <file>        record a chrome trace of every worker's games and searches
+//     --record <file>       append every game to a game record file, see core/GameRecord.h
+//
+// a config is a comma separated list of depth=<plies>, time=<ms per move> and eval=<variant>
+// eval variants are normal, none (pure search, every quiet position scores 0) and noise:<n> (adds up to +/-n)
+//
+#include "core/Connect4Position.h"
+#include "core/OthelloPosition.h"
+#include "core/CheckersPosition.h"
+#include "core/TicTacToePosition.h"
+#include "core/ChessSearch.h"
+#include "core/BitOps.h"
+#include "core/Search.h"
+#include "core/GameRecord.h"
+#include "core/Scheduler.h"
+#include "core/Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+enum class EvalVariant
+{
+    Normal,
+    None,
+    Noise
+};
+
+struct EngineConfig
+{
+    int         depth = 4;
+    int64_t     movetime = 0;
+    EvalVariant eval = EvalVariant::Normal;
+    int         noise = 0;
+
+    std::string describe() const
+    {
+        std::ostringstream text;
+        text << "depth=" << depth;
+        if (movetime > 0) text << ",time=" << movetime;
+        if (eval == EvalVariant::None) text << ",eval=none";
+        if (eval == EvalVariant::Noise) text << ",eval=noise:" << noise;
+        return text.str();
+    }
+};
+
+struct TournamentOptions
+{
+    std::string     game;
+    EngineConfig    engines[2];
+    int             games = 200;
+    int             threads = 0;
+    int             openingPlies = 4;
+    uint64_t        seed = 1;
+    bool            sprt = false;
+    double          elo0 = 0.0;
+    double          elo1 = 5.0;
+    double          alpha = 0.05;
+    double          beta = 0.05;
+    std::string     tracePath;
+    std::string     recordPath;
+};
+
+static bool parseConfig(const std::string &text, EngineConfig &config)
+{
+    std::istringstream items(text);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        size_t equals = item.find('=');
+        if (equals == std::string::npos) {
+            return false;
+        }
+        std::string key = item.substr(0, equals);
+        std::string value = item.substr(equals + 1);
+        if (key == "depth") {
+            config.depth = atoi(value.c_str());
+        } else if (key == "time") {
+            config.movetime = atoll(value.c_str());
+        } else if (key == "eval" && value == "normal") {
+            config.eval = EvalVariant::Normal;
+        } else if (key == "eval" && value == "none") {
+            config.eval = EvalVariant::None;
+        } else if (key == "eval" && value.compare(0, 6, "noise:") == 0) {
+            config.eval = EvalVariant::Noise;
+            config.noise = atoi(value.c_str() + 6);
+        } else {
+            return false;
+        }
+    }
+    // a time limit on its own means search as deep as the time allows
+    if (config.movetime > 0 && text.find("depth=") == std::string::npos) {
+        config.depth = SEARCH_MAX_PLY;
+    }
+    return config.depth > 0;
+}
+
+//
+// a position whose eval follows an engine config, the searcher only ever sees eval() so this is all it takes
+//
+template <class Position>
+class VariantPosition : public Position
+{
+public:
+    VariantPosition(const Position &position, const EngineConfig &config) : Position(position), _config(&config) {}
+
+    int eval() const
+    {
+        switch (_config->eval) {
+            case EvalVariant::None:
+                return 0;
+            case EvalVariant::Noise:
+            {
+                // the same position always gets the same noise, so a search stays consistent with itself
+                int range = 2 * _config->noise + 1;
+                return Position::eval() + (int)(Position::hash() % (uint64_t)range) - _config->noise;
+            }
+            default:
+                return Position::eval();
+        }
+    }
+
+private:
+    const EngineConfig *_config;
+};
+
+//
+// wins, draws and losses from engine A's side
+//
+struct Score
+{
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+
+    int     games() const { return wins + draws + losses; }
+    double  points() const { return wins + draws * 0.5; }
+};
+
+static double eloFromScore(double score)
+{
+    score = std::min(std::max(score, 1e-6), 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+static double scoreFromElo(double elo)
+{
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+// elo difference and the 95% interval half width, from the spread of the game results
+static void eloEstimate(const Score &score, double &elo, double &margin)
+{
+    int games = score.games();
+    if (games == 0) {
+        elo = margin = 0.0;
+        return;
+    }
+    double win = (double)score.wins / games;
+    double draw = (double)score.draws / games;
+    double mean = win + draw / 2;
+    double variance = win + draw / 4 - mean * mean;
+    double deviation = std::sqrt(std::max(variance, 0.0) / games);
+    elo = eloFromScore(mean);
+    margin = (eloFromScore(mean + 1.96 * deviation) - eloFromScore(mean - 1.96 * deviation)) / 2;
+}
+
+// log likelihood ratio of elo1 over elo0, normal approximation to the trinomial
+static double sprtLogLikelihoodRatio(const Score &score, double elo0, double elo1)
+{
+    int games = score.games();
+    if (games == 0) {
+        return 0.0;
+    }
+    double win = (double)score.wins / games;
+    double draw = (double)score.draws / games;
+    double mean = win + draw / 2;
+    // every game the same result would make the spread 0, floored at about what one drawn game among them
+    // would give so a match one side wins outright still gets to a verdict
+    double variance = std::max(win + draw / 4 - mean * mean, 1.0 / (4 * games));
+    double s0 = scoreFromElo(elo0);
+    double s1 = scoreFromElo(elo1);
+    return games * (s1 - s0) * (2 * mean - s0 - s1) / (2 * variance);
+}
+
+//
+// plays games as tasks on the shared scheduler, each task keeps its own positions and searchers and
+// takes the next game as it finishes one
+//
+template <class Position>
+class Tournament
+{
+public:
+    Tournament(const TournamentOptions &options) : _options(options), _nextGame(0), _stop(false) {}
+
+    Score run()
+    {
+        if (!_options.recordPath.empty() && !_records.open(_options.recordPath)) {
+            std::cout << "can't write " << _options.recordPath << std::endl;
+        }
+        int threads = _options.threads > 0 ? _options.threads : Scheduler::shared().threads();
+        threads = std::max(1, std::min(threads, _options.games));
+        std::vector<TaskHandle> tasks;
+        for (int i = 0; i < threads; i++) {
+            tasks.push_back(Scheduler::shared().submit([this](const std::atomic<bool> &stop) {
+                _worker();
+                return true;
+            }, Scheduler::NORMAL, "games"));
+        }
+        for (TaskHandle &task : tasks) {
+            task.wait();
+        }
+        _records.close();
+        return _score;
+    }
+
+private:
+    typedef typename SearcherFor<VariantPosition<Position>>::Type GameSearcher;
+
+    void _worker()
+    {
+        // searchers carry their principal variation tables inline, keep them off the worker's stack
+        std::unique_ptr<GameSearcher> searchers[2] = {
+            std::make_unique<GameSearcher>(),
+            std::make_unique<GameSearcher>(),
+        };
+        while (!_stop) {
+            int game = _nextGame++;
+            if (game >= _options.games) {
+                break;
+            }
+            // both games of a pair start from the same opening, A takes the first move in the even one
+            int engineA = game & 1;
+            TraceScope scope("game", "tournament", "game", game);
+            Position position = _opening(game / 2);
+            GameRecord record;
+            if (_records.isOpen()) {
+                gameRecordTitleFromName(_options.game, record.title);
+                record.start = position.stateString();
+                record.startSide = position.sideToMove();
+            }
+            int outcome;
+            // a game cut off when sprt decided isn't a result, it's kept in the record file as unfinished
+            if (_play(position, engineA, searchers, record.moves, outcome)) {
+                _record(outcome);
+            }
+            if (_records.isOpen()) {
+                record.result = gameRecordResult(position);
+                record.time = (uint64_t)std::time(nullptr);
+                _records.record(record);
+            }
+        }
+    }
+
+    Position _opening(int pair) const
+    {
+        // retry until the random plies leave a game still worth playing, give up on silly opening lengths
+        uint64_t seed = mixHash(_options.seed * 1000003 + pair);
+        for (int attempt = 0; attempt < 100; attempt++) {
+            Position position;
+            for (int ply = 0; ply < _options.openingPlies && !position.gameOver(); ply++) {
+                typename Position::Moves moves;
+                position.moves(moves);
+                seed = mixHash(seed);
+                position.play(moves[(int)(seed % (uint64_t)moves.size())]);
+            }
+            if (!position.gameOver()) {
+                return position;
+            }
+        }
+        return Position();
+    }
+
+    // outcome is 1 if A won, 0 for a draw, -1 if B won, false if the match was stopped before the game finished
+    // moves gets the code of every move played
+    bool _play(Position &position, int engineA, std::unique_ptr<GameSearcher> *searchers, std::vector<uint16_t> &moves, int &outcome)
+    {
+        // long enough for any real game, anything still going after this is called a draw
+        const int kMaxPlies = 600;
+        for (int ply = 0; ply < kMaxPlies && !position.gameOver() && !_stop; ply++) {
+            // player 0 is A when engineA is 0
+            int engine = position.sideToMove() == engineA ? 0 : 1;
+            const EngineConfig &config = _options.engines[engine];
+            VariantPosition<Position> view(position, config);
+            SearchLimits limits;
+            limits.depth = config.depth;
+            limits.movetime = config.movetime;
+            SearchResult<VariantPosition<Position>> result = searchers[engine]->search(view, limits);
+            if (!result.found) {
+                break;
+            }
+            moves.push_back(moveCode(result.bestMove));
+            position.play(result.bestMove);
+        }
+        if (_stop && !position.gameOver()) {
+            return false;
+        }
+        int winner = position.winner();
+        outcome = winner < 0 ? 0 : (winner == engineA ? 1 : -1);
+        return true;
+    }
+
+    void _record(int result)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (result > 0) _score.wins++;
+        else if (result < 0) _score.losses++;
+        else _score.draws++;
+
+        int games = _score.games();
+        if (games % 20 == 0 || games == _options.games) {
+            double elo, margin;
+            eloEstimate(_score, elo, margin);
+            printf("games %d  +%d =%d -%d  elo %+.1f +/- %.1f\n", games, _score.wins, _score.draws, _score.losses, elo, margin);
+            fflush(stdout);
+        }
+        if (_options.sprt) {
+            double llr = sprtLogLikelihoodRatio(_score, _options.elo0, _options.elo1);
+            double lower = std::log(_options.beta / (1 - _options.alpha));
+            double upper = std::log((1 - _options.beta) / _options.alpha);
+            if (llr <= lower || llr >= upper) {
+                _stop = true;
+            }
+        }
+    }
+
+    const TournamentOptions &_options;
+    std::atomic<int>    _nextGame;
+    std::atomic<bool>   _stop;
+    std::mutex          _mutex;
+    Score               _score;
+    GameRecordWriter    _records;
+};
+
+static void report(const TournamentOptions &options, const Score &score)
+{
+    double elo, margin;
+    eloEstimate(score, elo, margin);
+    printf("\n%s: A (%s) vs B (%s)\n", options.game.c_str(), options.engines[0].describe().c_str(), options.engines[1].describe().c_str());
+    printf("games %d  wins %d  draws %d  losses %d  score %.1f%%\n", score.games(), score.wins, score.draws, score.losses,
+           score.games() ? 100.0 * score.points() / score.games() : 0.0);
+    printf("elo difference %+.1f +/- %.1f (95%%)\n", elo, margin);
+    if (options.sprt) {
+        double llr = sprtLogLikelihoodRatio(score, options.elo0, options.elo1);
+        double lower = std::log(options.beta / (1 - options.alpha));
+        double upper = std::log((1 - options.beta) / options.alpha);
+        const char *verdict = llr >= upper ? "H1 accepted, A is stronger" : (llr <= lower ? "H0 accepted, A is not stronger" : "inconclusive");
+        printf("sprt [%.1f, %.1f] llr %.2f (%.2f, %.2f) %s\n", options.elo0, options.elo1, llr, lower, upper, verdict);
+    }
+}
+
+template <class Position>
+static void runTournament(const TournamentOptions &options)
+{
+    Tournament<Position> tournament(options);
+    report(options, tournament.run());
+}
+
+static int usage()
+{
+    std::cout << "usage: tournament <connect4|othello|checkers|tictactoe|chess> [--a config] [--b config] [--games n] [--threads n]\n"
+                 "                  [--openings plies] [--seed n] [--sprt elo0 elo1] [--alpha a] [--beta b] [--trace file]\n"
+                 "                  [--record file]\n"
+                 "config: depth=<plies>,time=<ms>,eval=<normal|none|noise:n>" << std::endl;
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        return usage();
+    }
+    TournamentOptions options;
+    options.game = argv[1];
+    bool haveB = false;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--a" && hasValue) {
+            if (!parseConfig(argv[++i], options.engines[0])) return usage();
+        } else if (arg == "--b" && hasValue) {
+            if (!parseConfig(argv[++i], options.engines[1])) return usage();
+            haveB = true;
+        } else if (arg == "--games" && hasValue) {
+            options.games = atoi(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = atoi(argv[++i]);
+        } else if (arg == "--openings" && hasValue) {
+            options.openingPlies = atoi(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--sprt" && i + 2 < argc) {
+            options.sprt = true;
+            options.elo0 = atof(argv[++i]);
+            options.elo1 = atof(argv[++i]);
+        } else if (arg == "--alpha" && hasValue) {
+            options.alpha = atof(argv[++i]);
+        } else if (arg == "--beta" && hasValue) {
+            options.beta = atof(argv[++i]);
+        } else if (arg == "--trace" && hasValue) {
+            options.tracePath = argv[++i];
+        } else if (arg == "--record" && hasValue) {
+            options.recordPath = argv[++i];
+        } else {
+            return usage();
+        }
+    }
+    if (!haveB) {
+        options.engines[1] = options.engines[0];
+    }
+    if (options.games <= 0) {
+        return usage();
+    }
+
+    if (!options.tracePath.empty()) {
+        Tracer::shared().setThreadName("main");
+        Tracer::shared().setEnabled(true);
+    }
+    if (options.game == "connect4") runTournament<Connect4Position>(options);
+    else if (options.game == "othello") runTournament<OthelloPosition>(options);
+    else if (options.game == "checkers") runTournament<CheckersPosition>(options);
+    else if (options.game == "tictactoe") runTournament<TicTacToePosition>(options);
+    else if (options.game == "chess") runTournament<ChessPosition>(options);
+    else return usage();
+    if (!options.tracePath.empty()) {
+        Tracer::shared().setEnabled(false);
+        if (!Tracer::shared().writeJson(options.tracePath)) {
+            std::cout << "can't write " << options.tracePath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -12,6 +12,7 @@
 #include <d3d11.h>
 #include <tchar.h>
 #include "Application.h"
+#include "classes/Profiler.h"
 
 // Data
 ID3D11Device*            g_pd3dDevice = nullptr;
@@ -20,6 +21,10 @@ static IDXGISwapChain*          g_pSwapChain = nullptr;
 static bool                     g_SwapChainOccluded = false;
 static UINT                     g_ResizeWidth = 0, g_ResizeHeight = 0;
 static ID3D11RenderTargetView*  g_mainRenderTargetView = nullptr;
+static HWND                     g_hWnd = nullptr;
+
+// Longest we sleep while idle, ImGui still gets the odd frame for its own timers (tooltips, blinking cursor)
+static const DWORD kIdleWaitMilliseconds = 250;
 
 // Forward declarations of helper functions
 bool CreateDeviceD3D(HWND hWnd);
@@ -106,12 +111,22 @@ int main(int, char**)
     ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 
     // Our state
+    g_hWnd = hwnd;
+    ClassGame::SetWakeUp([]() { ::PostMessage(g_hWnd, WM_NULL, 0, 0); });
     ClassGame::GameStartUp();
 
     // Main loop
     bool done = false;
     while (!done)
     {
+        // When nothing is changing (no input, no animation, no AI to move) sleep until a message arrives
+        // instead of presenting every vsync. A message arriving before the timeout gets a few frames drawn.
+        if (!ClassGame::NeedsRedraw())
+        {
+            if (::MsgWaitForMultipleObjects(0, nullptr, FALSE, kIdleWaitMilliseconds, QS_ALLINPUT) == WAIT_OBJECT_0)
+                ClassGame::RequestRedraw();
+        }
+
         // Poll and handle messages (inputs, window resize, etc.)
         // See the WndProc() function below for our to dispatch events to the Win32 backend.
         MSG msg;
@@ -143,12 +158,14 @@ int main(int, char**)
         }
 
         // Start the Dear ImGui frame
+        FrameProfiler::shared().beginFrame();
         ImGui_ImplDX11_NewFrame();
         ImGui_ImplWin32_NewFrame();
         ImGui::NewFrame();
         ClassGame::RenderGame();
 
         // Rendering
+        ProfileScope renderScope(ProfilePhase::Render);
         ImGui::Render();
         const float clear_color_with_alpha[4] = { clear_color.x * clear_color.w, clear_color.y * clear_color.w, clear_color.z * clear_color.w, clear_color.w };
         g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, nullptr);
@@ -161,6 +178,8 @@ int main(int, char**)
             ImGui::UpdatePlatformWindows();
             ImGui::RenderPlatformWindowsDefault();
         }
+        renderScope.stop();
+        FrameProfiler::shared().endFrame();
 
         // Present
         HRESULT hr = g_pSwapChain->Present(1, 0);   // Present with vsync